@@ -4,226 +4,752 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include "../stats/stats.h"
 #include "buddy.h"
+#include "slab.h"
+#include "block_store.h"
+#include "backing.h"
+#include "../my_sbrk.h"
+#include "tlsf.h"
+#include "first_fit.h"
+#include "best_fit.h"
+#include "worst_fit.h"
+#include "next_fit.h"
+#include "../observability/memory_dump.h"
+
+/* ================= HEAP INSTANCE ================= */
+
+struct mem_heap {
+    uint8_t *base;
+    size_t   total;
+    uint64_t sim_base;              /* reported address of offset 0 ... */
+    bool     sim_addresses;         /* ... if set, else the host address */
+    backing_t backing;              /* reserved arena, committed on demand */
+    my_sbrk_t brk;                  /* total = brk.brk, growable to brk.limit */
+
+    block_store_t blocks;
+
+    free_index_t free_idx;
+    tlsf_index_t tlsf_idx;
+    bool         tlsf_indexed;      /* which free index is live */
+    id_index_t   id_idx;
+
+    uint32_t next_id;
+    size_t   rover;                 /* next-fit: end of last allocation */
+    algo_t   algo;
+    _Atomic uint64_t generation;
+
+    buddy_pool_t buddy;
+    slab_pool_t  slab;
+    stats_t      stats;
+
+    /*
+     * One lock guards the heap: every public entry point takes it,
+     * internal *_locked helpers assume it is held.
+     */
+    pthread_mutex_t lock;
+};
+
+/* Process-wide source of generations, so no two heaps ever share one */
+static _Atomic uint64_t generation_counter;
+
+static void bump_generation(mem_heap_t *h)
+{
+    atomic_store(&h->generation, atomic_fetch_add(&generation_counter, 1) + 1);
+}
 
-/* ================= CONFIG ================= */
+/* ================= POLICY NAMES ================= */
 
-#define MAX_BLOCKS 1024
+static const char *const algo_names[] = {
+    [ALGO_FIRST_FIT] = "first",
+    [ALGO_BEST_FIT]  = "best",
+    [ALGO_WORST_FIT] = "worst",
+    [ALGO_BUDDY]     = "buddy",
+    [ALGO_SLAB]      = "slab",
+    [ALGO_TLSF]      = "tlsf",
+    [ALGO_NEXT_FIT]  = "next",
+};
 
-/* ================= GLOBALS ================= */
+int algo_from_name(const char *name, algo_t *out)
+{
+    for (size_t i = 0; i < sizeof(algo_names) / sizeof(algo_names[0]); i++) {
+        if (strcmp(name, algo_names[i]) == 0) {
+            *out = (algo_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
 
-static uint8_t *mem_base = NULL;
-static size_t   mem_total = 0;
+const char *algo_name(algo_t a)
+{
+    if ((size_t)a >= sizeof(algo_names) / sizeof(algo_names[0]))
+        return "unknown";
+    return algo_names[a];
+}
 
-static block_t  blocks[MAX_BLOCKS];
-static size_t   block_count = 0;
+/* ================= ACCESSORS ================= */
 
-static uint32_t next_id = 1;
-static algo_t   current_algo = ALGO_FIRST_FIT;
+uint8_t *allocator_get_base(const mem_heap_t *h) { return h->base; }
+size_t   allocator_get_total(const mem_heap_t *h) { return h->total; }
+size_t   allocator_get_limit(const mem_heap_t *h) { return h->brk.limit; }
 
-/* ================= ACCESSORS ================= */
+size_t   allocator_get_committed(const mem_heap_t *h)      { return backing_committed_bytes(&h->backing); }
+size_t   allocator_get_peak_committed(const mem_heap_t *h) { return backing_peak_committed_bytes(&h->backing); }
 
-uint8_t *allocator_get_base(void) { return mem_base; }
-size_t   allocator_get_total(void) { return mem_total; }
+size_t   allocator_get_block_count(const mem_heap_t *h) { return h->blocks.count; }
 
-block_t *allocator_get_blocks(void) { return blocks; }
-size_t   allocator_get_block_count(void) { return block_count; }
+uint64_t allocator_get_address_base(const mem_heap_t *h)
+{
+    return h->sim_addresses ? h->sim_base : (uint64_t)(uintptr_t)h->base;
+}
 
-/* ================= INIT / SHUTDOWN ================= */
+free_index_t *allocator_get_free_index(mem_heap_t *h) { return &h->free_idx; }
 
-int mem_init(size_t bytes)
+buddy_pool_t *allocator_get_buddy(mem_heap_t *h) { return &h->buddy; }
+slab_pool_t  *allocator_get_slab(mem_heap_t *h)  { return &h->slab; }
+stats_t      *allocator_get_stats(mem_heap_t *h) { return &h->stats; }
+
+/* Iteration in offset order; the pool node begins with its block_t */
+const block_t *allocator_first_block(const mem_heap_t *h)
 {
-    if (mem_base) {
-        fprintf(stderr, "memory already initialized\n");
-        return -1;
+    return h->blocks.head ? bstore_get(&h->blocks, h->blocks.head) : NULL;
+}
+
+const block_t *allocator_next_block(const mem_heap_t *h, const block_t *b)
+{
+    uint32_t next = ((const bstore_node_t *)b)->next;
+    return next ? bstore_get(&h->blocks, next) : NULL;
+}
+
+/* ================= FREE-SPACE INDEX ================= */
+
+/*
+ * First/best/worst fit share the AVL free index; TLSF keeps its own
+ * segregated lists. Only the one in use is maintained, and it is
+ * rebuilt from the block list when switching between the two.
+ *
+ * Inserting may need memory and fail (-1). Removing never fails, and
+ * the room it gives back is reused by the next insert, so an insert
+ * that follows a removal (same or merged block) always succeeds.
+ */
+static int free_insert(mem_heap_t *heap, uint32_t h)
+{
+    const block_t *b = bstore_get(&heap->blocks, h);
+
+    if (heap->tlsf_indexed)
+        return tlsf_insert(&heap->tlsf_idx, b->size, h);
+    return fidx_insert(&heap->free_idx, b->offset, b->size, h);
+}
+
+static void free_remove(mem_heap_t *heap, uint32_t h)
+{
+    const block_t *b = bstore_get(&heap->blocks, h);
+
+    if (heap->tlsf_indexed)
+        tlsf_remove(&heap->tlsf_idx, b->size, h);
+    else
+        fidx_remove(&heap->free_idx, b->offset, b->size);
+}
+
+static int rebuild_free_index(mem_heap_t *heap, bool use_tlsf)
+{
+    fidx_reset(&heap->free_idx);
+    tlsf_reset(&heap->tlsf_idx);
+    heap->tlsf_indexed = use_tlsf;
+
+    for (uint32_t h = heap->blocks.head; h; h = bstore_next(&heap->blocks, h)) {
+        if (bstore_get(&heap->blocks, h)->free && free_insert(heap, h) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Append 'inc' bytes of free space after the last block, merged into
+   it if it is free */
+static int append_free_locked(mem_heap_t *heap, size_t inc)
+{
+    block_store_t *bs = &heap->blocks;
+    uint32_t last = bs->tail;
+    block_t *b = bstore_get(bs, last);
+
+    if (b->free) {
+        free_remove(heap, last);
+        b->size += inc;
+        return free_insert(heap, last);
     }
 
-    mem_base = malloc(bytes);
-    if (!mem_base)
+    block_t space = {
+        .offset = b->offset + b->size,
+        .size = inc,
+        .requested_size = 0,
+        .free = true,
+        .id = 0
+    };
+    uint32_t r = bstore_insert_after(bs, last, &space);
+    if (!r)
+        return -1;
+    if (free_insert(heap, r) < 0) {
+        bstore_remove(bs, r);
         return -1;
+    }
+    return 0;
+}
+
+/* The fit blocks end where the heap did when a fit strategy last ran;
+   a buddy pool may have grown the heap since */
+static int cover_heap_locked(mem_heap_t *heap)
+{
+    const block_t *last = bstore_get(&heap->blocks, heap->blocks.tail);
+    size_t end = last->offset + last->size;
 
-    mem_total = bytes;
+    return end < heap->total ? append_free_locked(heap, heap->total - end) : 0;
+}
 
-    blocks[0] = (block_t){
+/* ================= INIT / SHUTDOWN ================= */
+
+mem_heap_t *mem_init(size_t bytes)
+{
+    return mem_init_growable(bytes, bytes);
+}
+
+mem_heap_t *mem_init_growable(size_t bytes, size_t max_bytes)
+{
+    if (bytes == 0 || max_bytes < bytes)
+        return NULL;
+
+    mem_heap_t *heap = calloc(1, sizeof(*heap));
+    if (!heap)
+        return NULL;
+
+    /* the whole limit is reserved; the break only marks the heap's end */
+    if (backing_init(&heap->backing, max_bytes) != 0) {
+        free(heap);
+        return NULL;
+    }
+    heap->base = heap->backing.base;
+    my_sbrk_init(&heap->brk, heap->base, max_bytes);
+    my_sbrk(&heap->brk, (ptrdiff_t)bytes);
+
+    heap->total = bytes;
+    heap->algo = ALGO_FIRST_FIT;
+    heap->next_id = 1;
+    bump_generation(heap);
+    pthread_mutex_init(&heap->lock, NULL);
+
+    block_t whole = {
         .offset = 0,
         .size = bytes,
         .requested_size = 0,
         .free = true,
         .id = 0
     };
-    block_count = 1;
-    next_id = 1;
-
-    stats_init(mem_total);
-
-    if (current_algo == ALGO_BUDDY)
-        buddy_init_pool(mem_base, mem_total);
+    bstore_reset(&heap->blocks);
+    if (!bstore_insert_after(&heap->blocks, 0, &whole)) {
+        mem_shutdown(heap);
+        return NULL;
+    }
 
-    return 0;
+    if (rebuild_free_index(heap, false) != 0) {
+        mem_shutdown(heap);
+        return NULL;
+    }
+    stats_init(&heap->stats, heap->total);
+    return heap;
 }
 
-void mem_shutdown(void)
+void mem_shutdown(mem_heap_t *heap)
 {
-    if (!mem_base)
+    if (!heap)
         return;
 
-    if (current_algo == ALGO_BUDDY)
-        buddy_shutdown_pool();
+    buddy_shutdown_pool(&heap->buddy);
+    slab_shutdown_pool(&heap->slab);
 
-    free(mem_base);
-    mem_base = NULL;
-    mem_total = 0;
-    block_count = 0;
+    backing_destroy(&heap->backing);
+    bstore_destroy(&heap->blocks);
+    fidx_destroy(&heap->free_idx);
+    tlsf_destroy(&heap->tlsf_idx);
+    ididx_destroy(&heap->id_idx);
 
-    stats_shutdown();
+    stats_shutdown(&heap->stats);
+    pthread_mutex_destroy(&heap->lock);
+    free(heap);
 }
 
 /* ================= CONFIG ================= */
 
-void set_allocator_algo(algo_t a)
+/*
+ * Everything the new strategy needs is built before the old one is
+ * torn down, so a failed switch leaves the heap as it was.
+ */
+static int set_algo_locked(mem_heap_t *heap, algo_t a)
 {
-    if (a == current_algo)
-        return;
+    bool fit = a != ALGO_BUDDY && a != ALGO_SLAB;
+    buddy_pool_t buddy = {0};
+    slab_pool_t  slab = {0};
+
+    if (a == heap->algo)
+        return 0;
+
+    if (a == ALGO_BUDDY && buddy_init_pool(&buddy, heap->base, heap->total) != 0)
+        return -1;
+    if (a == ALGO_SLAB && slab_init_pool(&slab, heap->base, heap->total) != 0)
+        return -1;
+
+    if (fit && cover_heap_locked(heap) != 0)
+        return -1;
 
-    if (current_algo == ALGO_BUDDY)
-        buddy_shutdown_pool();
+    /* switch the free index first: the old one was built over the same
+       free blocks, so it can always be rebuilt if the new one fails */
+    if (fit && (a == ALGO_TLSF) != heap->tlsf_indexed &&
+        rebuild_free_index(heap, a == ALGO_TLSF) != 0) {
+        rebuild_free_index(heap, a != ALGO_TLSF);
+        return -1;
+    }
 
-    current_algo = a;
+    if (heap->algo == ALGO_BUDDY)
+        buddy_shutdown_pool(&heap->buddy);
+    else if (heap->algo == ALGO_SLAB)
+        slab_shutdown_pool(&heap->slab);
 
-    if (current_algo == ALGO_BUDDY && mem_base)
-        buddy_init_pool(mem_base, mem_total);
+    if (a == ALGO_BUDDY)
+        heap->buddy = buddy;
+    else if (a == ALGO_SLAB)
+        heap->slab = slab;
+
+    heap->algo = a;
+    bump_generation(heap);
+    return 0;
 }
 
-algo_t get_allocator_algo(void)
+algo_t get_allocator_algo(const mem_heap_t *heap)
 {
-    return current_algo;
+    return heap->algo;
 }
 
 /* ================= INTERNAL HELPERS ================= */
 
-static int find_block(size_t bytes)
+static int find_block(mem_heap_t *heap, size_t bytes)
+{
+    switch (heap->algo) {
+    case ALGO_FIRST_FIT: return ff_find(heap, bytes);
+    case ALGO_BEST_FIT:  return bf_find(heap, bytes);
+    case ALGO_WORST_FIT: return wf_find(heap, bytes);
+    case ALGO_NEXT_FIT:  return nf_find(heap, bytes, heap->rover);
+    case ALGO_TLSF: {
+        uint32_t h;
+        return tlsf_find(&heap->tlsf_idx, bytes, &h) < 0 ? -1 : (int)h;
+    }
+    default:             return -1;
+    }
+}
+
+/* ================= GROWTH ================= */
+
+/*
+ * A growable heap starts at its initial size and moves its break up
+ * through my_sbrk when the fit or buddy strategies run out of room,
+ * like malloc extending the top of the heap. Slab pools keep the size
+ * they were created with.
+ */
+#define HEAP_GROW_STEP (64u * 1024)     /* smallest extension */
+
+/* Move the break up by at least 'need' bytes; the bytes added, or 0 */
+static size_t extend_locked(mem_heap_t *heap, size_t need)
 {
-    int best = -1;
+    size_t room = heap->brk.limit - heap->brk.brk;
+    size_t inc = (need + HEAP_GROW_STEP - 1) / HEAP_GROW_STEP * HEAP_GROW_STEP;
+
+    if (inc > room)
+        inc = room;
+    if (need == 0 || inc < need || !my_sbrk(&heap->brk, (ptrdiff_t)inc))
+        return 0;
+
+    heap->total = heap->brk.brk;
+    return inc;
+}
 
-    for (size_t i = 0; i < block_count; i++) {
-        if (!blocks[i].free || blocks[i].size < bytes)
-            continue;
+/* Fit strategies: extend until a request of 'bytes' fits at the end,
+   merging the new space into the trailing free block */
+static int grow_fit_locked(mem_heap_t *heap, size_t bytes)
+{
+    const block_t *last = bstore_get(&heap->blocks, heap->blocks.tail);
+    size_t have = last->free ? last->size : 0;
 
-        if (current_algo == ALGO_FIRST_FIT)
-            return (int)i;
+    /* a trailing block big enough that the index passed over (TLSF
+       rounds requests up) still needs one more step */
+    size_t inc = extend_locked(heap, bytes > have ? bytes - have : 1);
+    if (!inc)
+        return -1;
 
-        if (best == -1)
-            best = (int)i;
-        else if (current_algo == ALGO_BEST_FIT &&
-                 blocks[i].size < blocks[best].size)
-            best = (int)i;
-        else if (current_algo == ALGO_WORST_FIT &&
-                 blocks[i].size > blocks[best].size)
-            best = (int)i;
+    if (append_free_locked(heap, inc) != 0) {
+        my_sbrk(&heap->brk, -(ptrdiff_t)inc);
+        heap->total = heap->brk.brk;
+        return -1;
     }
-    return best;
+
+    stats_record_growth(&heap->stats, heap->total);
+    return 0;
+}
+
+/* Buddy: double the pool, extending the arena if it does not span it */
+static int grow_buddy_locked(mem_heap_t *heap)
+{
+    size_t want = buddy_get_size(&heap->buddy) * 2;
+    int extended = 0;
+
+    if (!buddy_get_base(&heap->buddy) || heap->buddy.max_order >= BUDDY_MAX_ORDER)
+        return -1;
+
+    if (heap->total < want) {
+        if (!extend_locked(heap, want - heap->total))
+            return -1;
+        extended = 1;
+    }
+
+    if (buddy_grow(&heap->buddy) != 0)
+        return -1;
+
+    if (extended)
+        stats_record_growth(&heap->stats, heap->total);
+    return 0;
 }
 
 /* ================= ALLOC ================= */
 
-uint32_t mem_alloc(size_t bytes)
+/* Counts the attempt and any failure; alloc_locked counts the success */
+static uint32_t place_locked(mem_heap_t *heap, size_t bytes)
 {
-    if (!mem_base || bytes == 0)
+    if (bytes == 0)
         return 0;
 
-    stats_record_alloc_attempt();
+    stats_record_alloc_attempt(&heap->stats);
 
-    if (current_algo == ALGO_BUDDY) {
-        uint32_t id = buddy_alloc(bytes);
-        if (id)
-            stats_record_alloc_success();
-        else
-            stats_record_alloc_failure();
+    if (heap->algo == ALGO_BUDDY || heap->algo == ALGO_SLAB) {
+        uint32_t id = (heap->algo == ALGO_BUDDY)
+                          ? buddy_alloc(&heap->buddy, bytes)
+                          : slab_alloc(&heap->slab, bytes);
+        while (!id && heap->algo == ALGO_BUDDY && grow_buddy_locked(heap) == 0)
+            id = buddy_alloc(&heap->buddy, bytes);
+        if (!id)
+            stats_record_alloc_failure(&heap->stats);
         return id;
     }
 
-    int idx = find_block(bytes);
-    if (idx < 0) {
-        stats_record_alloc_failure();
+    int h = find_block(heap, bytes);
+    while (h < 0 && grow_fit_locked(heap, bytes) == 0)
+        h = find_block(heap, bytes);
+    if (h < 0) {
+        stats_record_alloc_failure(&heap->stats);
         return 0;
     }
 
-    block_t *b = &blocks[idx];
+    block_t *b = bstore_get(&heap->blocks, (uint32_t)h);
+    uint32_t id = heap->next_id;
 
-    if (b->size > bytes) {
-        memmove(&blocks[idx + 2], &blocks[idx + 1],
-                (block_count - idx - 1) * sizeof(block_t));
+    /* index the allocation first: nothing to undo if that fails */
+    if (ididx_put(&heap->id_idx, id, b->offset, bytes, (uint32_t)h) < 0) {
+        stats_record_alloc_failure(&heap->stats);
+        return 0;
+    }
+
+    free_remove(heap, (uint32_t)h);
 
-        blocks[idx + 1] = (block_t){
+    if (b->size > bytes) {
+        block_t rest = {
             .offset = b->offset + bytes,
             .size = b->size - bytes,
             .requested_size = 0,
             .free = true,
             .id = 0
         };
-        block_count++;
-        b->size = bytes;
+        uint32_t r = bstore_insert_after(&heap->blocks, (uint32_t)h, &rest);
+        b = bstore_get(&heap->blocks, (uint32_t)h);   /* pool may have moved */
+        if (r) {
+            b->size = bytes;
+            if (free_insert(heap, r) < 0) {
+                b->size += rest.size;
+                bstore_remove(&heap->blocks, r);
+                r = 0;
+            }
+        }
+        if (!r) {
+            free_insert(heap, (uint32_t)h);
+            ididx_del(&heap->id_idx, id);
+            stats_record_alloc_failure(&heap->stats);
+            return 0;
+        }
     }
 
     b->free = false;
-    b->id = next_id++;
+    b->id = id;
     b->requested_size = bytes;
+    heap->next_id++;
+
+    heap->rover = b->offset + bytes;
+    if (heap->rover >= heap->total)
+        heap->rover = 0;
 
-    stats_record_alloc_success();
     return b->id;
 }
 
 /* ================= FREE ================= */
 
-int mem_free(uint32_t id)
+/* Uncounted, so alloc_locked can also use it to undo a placement */
+static int release_locked(mem_heap_t *heap, uint32_t id)
 {
-    if (current_algo == ALGO_BUDDY) {
-        int r = buddy_free(id);
-        if (r == 0)
-            stats_record_free();
-        return r;
+    if (heap->algo == ALGO_BUDDY || heap->algo == ALGO_SLAB) {
+        return (heap->algo == ALGO_BUDDY) ? buddy_free(&heap->buddy, id)
+                                          : slab_free(&heap->slab, id);
     }
 
-    for (size_t i = 0; i < block_count; i++) {
-        if (!blocks[i].free && blocks[i].id == id) {
+    block_store_t *bs = &heap->blocks;
+    const ididx_entry_t *e = ididx_get(&heap->id_idx, id);
+    if (!e)
+        return -1;
 
-            blocks[i].free = true;
-            blocks[i].id = 0;
-            blocks[i].requested_size = 0;
+    uint32_t h = e->ref;
+    uint32_t next = bstore_next(bs, h);
+    uint32_t prev = bstore_prev(bs, h);
+    bool merge_next = next && bstore_get(bs, next)->free;
+    bool merge_prev = prev && bstore_get(bs, prev)->free;
 
-            stats_record_free();
+    /* a block that keeps its handle is indexed before anything changes,
+       so if that fails the allocation is still intact */
+    if (!merge_prev && free_insert(heap, h) < 0)
+        return -1;
 
-            if (i + 1 < block_count && blocks[i + 1].free) {
-                blocks[i].size += blocks[i + 1].size;
-                memmove(&blocks[i + 1], &blocks[i + 2],
-                        (block_count - i - 2) * sizeof(block_t));
-                block_count--;
-            }
+    block_t *b = bstore_get(bs, h);
+    ididx_del(&heap->id_idx, id);
 
-            if (i > 0 && blocks[i - 1].free) {
-                blocks[i - 1].size += blocks[i].size;
-                memmove(&blocks[i], &blocks[i + 1],
-                        (block_count - i - 1) * sizeof(block_t));
-                block_count--;
-            }
+    b->free = true;
+    b->id = 0;
+    b->requested_size = 0;
 
-            return 0;
-        }
+    if (merge_next) {
+        block_t *n = bstore_get(bs, next);
+        free_remove(heap, next);
+        if (!merge_prev)
+            free_remove(heap, h);
+        b->size += n->size;
+        bstore_remove(bs, next);
     }
-    return -1;
+
+    if (merge_prev) {
+        block_t *p = bstore_get(bs, prev);
+        free_remove(heap, prev);
+        p->size += b->size;
+        bstore_remove(bs, h);
+        h = prev;
+    } else if (!merge_next) {
+        return 0;
+    }
+
+    return free_insert(heap, h);
+}
+
+/* ================= ID / ADDRESS LOOKUP ================= */
+
+static void *id_to_ptr_locked(mem_heap_t *heap, uint32_t id)
+{
+    if (id == 0)
+        return NULL;
+
+    if (heap->algo == ALGO_BUDDY)
+        return buddy_allocated_address(&heap->buddy, id);
+    if (heap->algo == ALGO_SLAB)
+        return slab_allocated_address(&heap->slab, id);
+
+    const ididx_entry_t *e = ididx_get(&heap->id_idx, id);
+    return e ? heap->base + e->offset : NULL;
+}
+
+static uint32_t ptr_to_id_locked(mem_heap_t *heap, const void *ptr)
+{
+    if (!ptr)
+        return 0;
+
+    if (heap->algo == ALGO_BUDDY)
+        return buddy_address_to_id(&heap->buddy, ptr);
+    if (heap->algo == ALGO_SLAB)
+        return slab_address_to_id(&heap->slab, ptr);
+
+    const uint8_t *p = ptr;
+    if (p < heap->base || p >= heap->base + heap->total)
+        return 0;
+
+    return ididx_id_at(&heap->id_idx, (size_t)(p - heap->base));
+}
+
+static size_t requested_size_locked(mem_heap_t *heap, uint32_t id)
+{
+    if (heap->algo == ALGO_BUDDY)
+        return buddy_allocated_size(&heap->buddy, id);
+    if (heap->algo == ALGO_SLAB)
+        return slab_allocated_size(&heap->slab, id);
+
+    const ididx_entry_t *e = ididx_get(&heap->id_idx, id);
+    return e ? e->requested_size : 0;
+}
+
+/* ================= BACKING ================= */
+
+/*
+ * The arena's host memory is committed under live allocations only
+ * (see backing.h). Strategy switches drop allocations without freeing
+ * them, which leaves their chunks counted: committed, never unsafe.
+ */
+
+/*
+ * Place the block, then commit the backing under the bytes the caller
+ * may touch. Only then is the allocation counted: out of host memory
+ * the placement is undone and the attempt counts as one failure.
+ */
+static uint32_t alloc_locked(mem_heap_t *heap, size_t bytes)
+{
+    uint32_t id = place_locked(heap, bytes);
+    if (!id)
+        return 0;
+
+    size_t off = (size_t)((uint8_t *)id_to_ptr_locked(heap, id) - heap->base);
+    if (backing_acquire(&heap->backing, off, bytes) != 0) {
+        release_locked(heap, id);
+        stats_record_alloc_failure(&heap->stats);
+        return 0;
+    }
+
+    stats_record_alloc_success(&heap->stats);
+    return id;
+}
+
+/* Free the block, then uncount its backing */
+static int free_locked(mem_heap_t *heap, uint32_t id)
+{
+    uint8_t *p = id_to_ptr_locked(heap, id);
+    size_t req = p ? requested_size_locked(heap, id) : 0;
+
+    if (release_locked(heap, id) != 0)
+        return -1;
+
+    stats_record_free(&heap->stats);
+    backing_release(&heap->backing, (size_t)(p - heap->base), req);
+    return 0;
+}
+
+/* ================= LOCKED PUBLIC API ================= */
+
+int set_allocator_algo(mem_heap_t *heap, algo_t a)
+{
+    pthread_mutex_lock(&heap->lock);
+    int r = set_algo_locked(heap, a);
+    pthread_mutex_unlock(&heap->lock);
+    return r;
+}
+
+uint32_t mem_alloc(mem_heap_t *heap, size_t bytes)
+{
+    pthread_mutex_lock(&heap->lock);
+    uint32_t id = alloc_locked(heap, bytes);
+    pthread_mutex_unlock(&heap->lock);
+    return id;
+}
+
+int mem_free(mem_heap_t *heap, uint32_t id)
+{
+    pthread_mutex_lock(&heap->lock);
+    int r = free_locked(heap, id);
+    pthread_mutex_unlock(&heap->lock);
+    return r;
+}
+
+void *mem_id_to_ptr(mem_heap_t *heap, uint32_t id)
+{
+    pthread_mutex_lock(&heap->lock);
+    void *p = id_to_ptr_locked(heap, id);
+    pthread_mutex_unlock(&heap->lock);
+    return p;
+}
+
+uint32_t mem_ptr_to_id(mem_heap_t *heap, const void *ptr)
+{
+    pthread_mutex_lock(&heap->lock);
+    uint32_t id = ptr_to_id_locked(heap, ptr);
+    pthread_mutex_unlock(&heap->lock);
+    return id;
+}
+
+size_t mem_requested_size(mem_heap_t *heap, uint32_t id)
+{
+    pthread_mutex_lock(&heap->lock);
+    size_t sz = requested_size_locked(heap, id);
+    pthread_mutex_unlock(&heap->lock);
+    return sz;
+}
+
+void mem_set_address_base(mem_heap_t *heap, uint64_t base)
+{
+    pthread_mutex_lock(&heap->lock);
+    heap->sim_base = base;
+    heap->sim_addresses = true;
+    pthread_mutex_unlock(&heap->lock);
+}
+
+void mem_use_host_addresses(mem_heap_t *heap)
+{
+    pthread_mutex_lock(&heap->lock);
+    heap->sim_base = 0;
+    heap->sim_addresses = false;
+    pthread_mutex_unlock(&heap->lock);
+}
+
+uint64_t mem_address_base(mem_heap_t *heap)
+{
+    pthread_mutex_lock(&heap->lock);
+    uint64_t base = allocator_get_address_base(heap);
+    pthread_mutex_unlock(&heap->lock);
+    return base;
+}
+
+/* 'ptr' must point into the arena */
+uint64_t mem_ptr_to_address(mem_heap_t *heap, const void *ptr)
+{
+    return mem_address_base(heap) + (uint64_t)((const uint8_t *)ptr - heap->base);
+}
+
+/* Any address is valid with a simulated base of 0, so liveness is
+   reported apart from it */
+int mem_id_to_address(mem_heap_t *heap, uint32_t id, uint64_t *addr)
+{
+    pthread_mutex_lock(&heap->lock);
+    const uint8_t *p = id_to_ptr_locked(heap, id);
+    if (p)
+        *addr = allocator_get_address_base(heap) + (uint64_t)(p - heap->base);
+    pthread_mutex_unlock(&heap->lock);
+    return p ? 0 : -1;
+}
+
+/* Lock-free so per-thread caches can validate without the heap lock */
+uint64_t mem_generation(const mem_heap_t *heap)
+{
+    return atomic_load(&heap->generation);
 }
 
 /* ================= DUMP / STATS ================= */
 
-void mem_dump(void)
+void mem_dump(mem_heap_t *heap)
 {
-    extern void memory_dump(void);
-    memory_dump();
+    pthread_mutex_lock(&heap->lock);
+    memory_dump(heap);
+    pthread_mutex_unlock(&heap->lock);
 }
 
-void mem_stats_print(void)
+void mem_stats_print(mem_heap_t *heap)
 {
-    stats_print();
+    pthread_mutex_lock(&heap->lock);
+    stats_print(heap);
+    pthread_mutex_unlock(&heap->lock);
 }
@@ -5,15 +5,25 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "free_index.h"
+#include "id_index.h"
+
 /* ================= ALLOCATOR POLICY ================= */
 
 typedef enum {
     ALGO_FIRST_FIT = 0,
     ALGO_BEST_FIT,
     ALGO_WORST_FIT,
-    ALGO_BUDDY
+    ALGO_BUDDY,
+    ALGO_SLAB,
+    ALGO_TLSF,
+    ALGO_NEXT_FIT
 } algo_t;
 
+/* CLI / trace names: first, next, best, worst, buddy, slab, tlsf */
+int         algo_from_name(const char *name, algo_t *out);   /* 0 or -1 */
+const char *algo_name(algo_t a);
+
 /* ================= OUT-OF-BAND METADATA ================= */
 
 /*
@@ -33,34 +43,103 @@ typedef struct {
     uint32_t id;            /* allocation id */
 } block_t;
 
+/* ================= HEAP HANDLE ================= */
+
+/*
+ * Every heap is an independent instance: its own arena, block metadata,
+ * strategy, statistics and lock. Any number of heaps may coexist in one
+ * process, each running a different policy.
+ */
+typedef struct mem_heap mem_heap_t;
+
+struct buddy_pool;
+struct slab_pool;
+struct stats;
+
 /* ================= CORE API ================= */
 
-int mem_init(size_t bytes);
-void mem_shutdown(void);
+/*
+ * Thread safety: every function in this section and the ID / address
+ * lookups below serialize on the heap's own lock, so they may be called
+ * from any thread, and different heaps never contend. The METADATA
+ * ACCESS iterators are not locked; they are meant for dump and stats,
+ * which run under mem_dump() and mem_stats_print().
+ */
+
+/* New heap of 'bytes' using first fit; NULL on failure */
+mem_heap_t *mem_init(size_t bytes);
+
+/* Same, but when the fit or buddy strategies run out of room the heap
+   grows (through my_sbrk) up to 'max_bytes' */
+mem_heap_t *mem_init_growable(size_t bytes, size_t max_bytes);
+void mem_shutdown(mem_heap_t *heap);
 
-void set_allocator_algo(algo_t a);
-algo_t get_allocator_algo(void);
+/* 0, or -1 (out of memory) with the heap left on its old strategy */
+int set_allocator_algo(mem_heap_t *heap, algo_t a);
+algo_t get_allocator_algo(const mem_heap_t *heap);
 
-int mem_set_cache(int on);
-int mem_get_cache(void);
+uint32_t mem_alloc(mem_heap_t *heap, size_t bytes);
+int mem_free(mem_heap_t *heap, uint32_t alloc_id);
 
-uint32_t mem_alloc(size_t bytes);
-int mem_free(uint32_t alloc_id);
+/* ================= ID / ADDRESS LOOKUP ================= */
+
+/* O(1) through the allocation index, for every strategy */
+void    *mem_id_to_ptr(mem_heap_t *heap, uint32_t id);
+uint32_t mem_ptr_to_id(mem_heap_t *heap, const void *ptr);
+size_t   mem_requested_size(mem_heap_t *heap, uint32_t id);
+
+/*
+ * Addresses as the simulation sees them (cache, TLB, dump, CLI): the
+ * host arena's by default, or offsets from a fixed simulated base (any
+ * value, 0 included) so results do not depend on where the arena
+ * happened to land. mem_use_host_addresses() switches back.
+ */
+void     mem_set_address_base(mem_heap_t *heap, uint64_t base);
+void     mem_use_host_addresses(mem_heap_t *heap);
+uint64_t mem_address_base(mem_heap_t *heap);               /* of offset 0 */
+uint64_t mem_ptr_to_address(mem_heap_t *heap, const void *ptr);
+int      mem_id_to_address(mem_heap_t *heap, uint32_t id,     /* 0, or -1 */
+                           uint64_t *addr);                    /* if not live */
+
+/* Changes on mem_init and strategy switches, and is never reused by any
+   heap in the process; callers that cache pointers (per-thread caches)
+   use it to detect a reset heap */
+uint64_t mem_generation(const mem_heap_t *heap);
 
 /* ================= OBSERVABILITY ================= */
 
-void mem_dump(void);
-void mem_stats_print(void);
+void mem_dump(mem_heap_t *heap);
+void mem_stats_print(mem_heap_t *heap);
 
 /* ================= HEAP ACCESS ================= */
 
-uint8_t *allocator_get_base(void);
-size_t   allocator_get_total(void);
+uint8_t *allocator_get_base(const mem_heap_t *heap);
+size_t   allocator_get_total(const mem_heap_t *heap);   /* current size */
+size_t   allocator_get_limit(const mem_heap_t *heap);   /* growth limit */
+
+/* Host memory committed under the arena now / at most (see backing.h) */
+size_t   allocator_get_committed(const mem_heap_t *heap);
+size_t   allocator_get_peak_committed(const mem_heap_t *heap);
 
 /* ================= METADATA ACCESS ================= */
 
-/* Used by dump, stats, and fit algorithms */
-block_t *allocator_get_blocks(void);
-size_t   allocator_get_block_count(void);
+/*
+ * Used by dump and stats. Blocks are visited in offset order:
+ *   for (b = allocator_first_block(h); b; b = allocator_next_block(h, b))
+ */
+const block_t *allocator_first_block(const mem_heap_t *heap);
+const block_t *allocator_next_block(const mem_heap_t *heap, const block_t *b);
+size_t         allocator_get_block_count(const mem_heap_t *heap);
+
+/* mem_address_base() for dump, which already holds the lock */
+uint64_t       allocator_get_address_base(const mem_heap_t *heap);
+
+/* Free-space index over the free blocks (fit algorithms) */
+free_index_t *allocator_get_free_index(mem_heap_t *heap);
+
+/* Per-strategy pools and counters owned by the heap */
+struct buddy_pool *allocator_get_buddy(mem_heap_t *heap);
+struct slab_pool  *allocator_get_slab(mem_heap_t *heap);
+struct stats      *allocator_get_stats(mem_heap_t *heap);
 
 #endif /* ALLOCATOR_H */
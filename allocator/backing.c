@@ -0,0 +1,205 @@
+#define _GNU_SOURCE
+#include "backing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/* ================= OS INTERFACE ================= */
+
+#ifdef _WIN32
+
+static void *os_reserve(size_t len)
+{
+    return VirtualAlloc(NULL, len, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static int os_commit(void *p, size_t len)
+{
+    return VirtualAlloc(p, len, MEM_COMMIT, PAGE_READWRITE) ? 0 : -1;
+}
+
+static void os_decommit(void *p, size_t len)
+{
+    VirtualFree(p, len, MEM_DECOMMIT);
+}
+
+static void os_unreserve(void *p, size_t len)
+{
+    (void)len;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+
+#else
+
+static void *os_reserve(size_t len)
+{
+    void *p = mmap(NULL, len, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static int os_commit(void *p, size_t len)
+{
+    return mprotect(p, len, PROT_READ | PROT_WRITE);
+}
+
+/* Drop the pages first so the range holds no memory, then fence it */
+static void os_decommit(void *p, size_t len)
+{
+    madvise(p, len, MADV_DONTNEED);
+    mprotect(p, len, PROT_NONE);
+}
+
+static void os_unreserve(void *p, size_t len)
+{
+    munmap(p, len);
+}
+
+#endif
+
+/* ================= LIFECYCLE ================= */
+
+int backing_init(backing_t *bk, size_t bytes)
+{
+    memset(bk, 0, sizeof(*bk));
+    if (bytes == 0)
+        return -1;
+
+    bk->nchunks = (bytes + BACKING_CHUNK - 1) / BACKING_CHUNK;
+    bk->reserved = bk->nchunks * BACKING_CHUNK;
+    if (bk->reserved < bytes)
+        return -1;
+
+    bk->chunks = calloc(bk->nchunks, sizeof(backing_chunk_t));
+    bk->idle = malloc(bk->nchunks * sizeof(uint32_t));
+    bk->base = (bk->chunks && bk->idle) ? os_reserve(bk->reserved) : NULL;
+    if (!bk->base) {
+        backing_destroy(bk);
+        return -1;
+    }
+    return 0;
+}
+
+void backing_destroy(backing_t *bk)
+{
+    if (bk->base)
+        os_unreserve(bk->base, bk->reserved);
+    free(bk->chunks);
+    free(bk->idle);
+    memset(bk, 0, sizeof(*bk));
+}
+
+/* ================= COMMIT / RELEASE ================= */
+
+/* Commit chunks [first, last) that are not yet, one call per run */
+static int commit_range(backing_t *bk, size_t first, size_t last)
+{
+    size_t c = first;
+
+    while (c < last) {
+        if (bk->chunks[c].committed) {
+            c++;
+            continue;
+        }
+
+        size_t run = c;
+        while (run < last && !bk->chunks[run].committed)
+            run++;
+
+        if (os_commit(bk->base + c * BACKING_CHUNK, (run - c) * BACKING_CHUNK) != 0)
+            return -1;
+
+        /* idle until the caller counts them live; queued so that a
+           failure further on cannot strand them committed */
+        for (; c < run; c++) {
+            bk->chunks[c].committed = 1;
+            bk->committed_chunks++;
+            bk->idle_chunks++;
+            if (!bk->chunks[c].queued) {
+                bk->chunks[c].queued = 1;
+                bk->idle[bk->nidle_queued++] = (uint32_t)c;
+            }
+        }
+    }
+
+    if (bk->committed_chunks > bk->peak_committed_chunks)
+        bk->peak_committed_chunks = bk->committed_chunks;
+    return 0;
+}
+
+int backing_acquire(backing_t *bk, size_t off, size_t len)
+{
+    if (len == 0)
+        return 0;
+
+    size_t first = off / BACKING_CHUNK;
+    size_t last = (off + len - 1) / BACKING_CHUNK + 1;
+
+    if (commit_range(bk, first, last) != 0)
+        return -1;
+
+    for (size_t c = first; c < last; c++) {
+        if (bk->chunks[c].live++ == 0)
+            bk->idle_chunks--;
+    }
+    return 0;
+}
+
+void backing_release(backing_t *bk, size_t off, size_t len)
+{
+    if (len == 0)
+        return;
+
+    size_t first = off / BACKING_CHUNK;
+    size_t last = (off + len - 1) / BACKING_CHUNK + 1;
+
+    for (size_t c = first; c < last; c++) {
+        backing_chunk_t *ch = &bk->chunks[c];
+
+        if (--ch->live > 0)
+            continue;
+
+        bk->idle_chunks++;
+        if (!ch->queued) {
+            ch->queued = 1;
+            bk->idle[bk->nidle_queued++] = (uint32_t)c;
+        }
+    }
+
+    if (bk->idle_chunks > BACKING_SLACK_CHUNKS)
+        backing_trim(bk);
+}
+
+/* Chunks on the stack may have been reused since; only still-idle ones go */
+void backing_trim(backing_t *bk)
+{
+    while (bk->nidle_queued > 0) {
+        backing_chunk_t *ch = &bk->chunks[bk->idle[--bk->nidle_queued]];
+        size_t c = (size_t)(ch - bk->chunks);
+
+        ch->queued = 0;
+        if (ch->live > 0 || !ch->committed)
+            continue;
+
+        os_decommit(bk->base + c * BACKING_CHUNK, BACKING_CHUNK);
+        ch->committed = 0;
+        bk->committed_chunks--;
+        bk->idle_chunks--;
+    }
+}
+
+size_t backing_committed_bytes(const backing_t *bk)
+{
+    return bk->committed_chunks * BACKING_CHUNK;
+}
+
+size_t backing_peak_committed_bytes(const backing_t *bk)
+{
+    return bk->peak_committed_chunks * BACKING_CHUNK;
+}
@@ -0,0 +1,61 @@
+#ifndef BACKING_H
+#define BACKING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lazily committed backing store for a heap arena.
+ *
+ * The whole arena is reserved up front as inaccessible address space
+ * (mmap PROT_NONE | MAP_NORESERVE) and committed in BACKING_CHUNK
+ * pieces as allocations first cover them. Each chunk counts the live
+ * allocations overlapping it; a chunk left with none is idle, and once
+ * more than BACKING_SLACK_CHUNKS are idle they are handed back to the
+ * OS (MADV_DONTNEED, then PROT_NONE again). The slack keeps alloc/free
+ * churn inside one chunk from turning into system calls.
+ *
+ * Host memory use therefore follows the live data rather than the
+ * nominal heap size, and arenas larger than RAM can be simulated.
+ * Contents of released chunks are lost, which is safe because the heap
+ * holds user payload only.
+ */
+#define BACKING_CHUNK        (64u * 1024)
+#define BACKING_SLACK_CHUNKS 64           /* 4 MB idle before releasing */
+
+typedef struct {
+    uint32_t live;            /* allocations overlapping the chunk */
+    uint8_t  committed;
+    uint8_t  queued;          /* on the idle stack */
+} backing_chunk_t;
+
+typedef struct {
+    uint8_t         *base;
+    size_t           reserved;        /* bytes, whole chunks */
+    size_t           nchunks;
+    backing_chunk_t *chunks;
+    uint32_t        *idle;            /* stack of chunks that went idle */
+    size_t           nidle_queued;
+    size_t           idle_chunks;     /* committed and unused */
+    size_t           committed_chunks;
+    size_t           peak_committed_chunks;
+} backing_t;
+
+/* Reserve 'bytes' of address space; 0 or -1 */
+int  backing_init(backing_t *bk, size_t bytes);
+void backing_destroy(backing_t *bk);
+
+/* An allocation now covers [off, off + len): commit what it needs.
+   -1 if the OS refuses, with nothing counted */
+int  backing_acquire(backing_t *bk, size_t off, size_t len);
+
+/* The allocation covering [off, off + len) is gone */
+void backing_release(backing_t *bk, size_t off, size_t len);
+
+/* Hand every idle chunk back now */
+void backing_trim(backing_t *bk);
+
+size_t backing_committed_bytes(const backing_t *bk);
+size_t backing_peak_committed_bytes(const backing_t *bk);
+
+#endif /* BACKING_H */
@@ -3,21 +3,15 @@
 
 /*
  * Best-fit on out-of-band metadata
- * Returns index of best suitable block, or -1
+ * Answered by the free-space index in O(log n)
+ * Returns block-store handle of best suitable block, or -1
  */
 
-int bf_find(size_t req) {
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
+int bf_find(mem_heap_t *heap, size_t req) {
+    uint32_t h;
 
-    int best = -1;
+    if (fidx_best_fit(allocator_get_free_index(heap), req, &h) < 0)
+        return -1;
 
-    for (size_t i = 0; i < count; i++) {
-        if (blocks[i].free && blocks[i].size >= req) {
-            if (best == -1 || blocks[i].size < blocks[best].size) {
-                best = (int)i;
-            }
-        }
-    }
-    return best;
+    return (int)h;
 }
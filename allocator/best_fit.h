@@ -3,10 +3,12 @@
 
 #include <stddef.h>
 
+#include "allocator.h"
+
 /*
  * Best-fit allocator (out-of-band metadata)
- * Returns index of best suitable free block, or -1
+ * Returns block-store handle of best suitable free block, or -1
  */
-int bf_find(size_t req);
+int bf_find(mem_heap_t *heap, size_t req);
 
 #endif /* BEST_FIT_H */
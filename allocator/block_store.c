@@ -0,0 +1,91 @@
+#include "block_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NIL 0u
+
+/* ================= NODE POOL ================= */
+
+static uint32_t node_new(block_store_t *bs)
+{
+    if (bs->free_head != NIL) {
+        uint32_t n = bs->free_head;
+        bs->free_head = bs->nodes[n].next;
+        return n;
+    }
+
+    if (bs->used >= bs->cap) {
+        uint32_t cap = bs->cap ? bs->cap * 2 : 64;
+        bstore_node_t *p = realloc(bs->nodes, cap * sizeof(bstore_node_t));
+        if (!p)
+            return NIL;
+        bs->nodes = p;
+        bs->cap = cap;
+    }
+    return bs->used++;
+}
+
+/* ================= LIFECYCLE ================= */
+
+void bstore_reset(block_store_t *bs)
+{
+    bs->used = 1;               /* slot 0 is nil */
+    bs->free_head = NIL;
+    bs->head = bs->tail = NIL;
+    bs->count = 0;
+}
+
+void bstore_destroy(block_store_t *bs)
+{
+    free(bs->nodes);
+    memset(bs, 0, sizeof(*bs));
+}
+
+/* ================= LIST OPS ================= */
+
+uint32_t bstore_insert_after(block_store_t *bs, uint32_t at, const block_t *b)
+{
+    uint32_t n = node_new(bs);
+    if (n == NIL)
+        return NIL;
+
+    bstore_node_t *x = &bs->nodes[n];
+    uint32_t next = at ? bs->nodes[at].next : bs->head;
+
+    x->blk = *b;
+    x->prev = at;
+    x->next = next;
+
+    if (at)
+        bs->nodes[at].next = n;
+    else
+        bs->head = n;
+
+    if (next)
+        bs->nodes[next].prev = n;
+    else
+        bs->tail = n;
+
+    bs->count++;
+    return n;
+}
+
+void bstore_remove(block_store_t *bs, uint32_t h)
+{
+    bstore_node_t *x = &bs->nodes[h];
+
+    if (x->prev)
+        bs->nodes[x->prev].next = x->next;
+    else
+        bs->head = x->next;
+
+    if (x->next)
+        bs->nodes[x->next].prev = x->prev;
+    else
+        bs->tail = x->prev;
+
+    x->next = bs->free_head;
+    bs->free_head = h;
+    bs->count--;
+}
@@ -0,0 +1,61 @@
+#ifndef BLOCK_STORE_H
+#define BLOCK_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+
+/*
+ * Growable store for out-of-band block_t metadata.
+ *
+ * Blocks live in one pooled node array and are chained into a doubly
+ * linked list kept in offset order. Split and coalesce are O(1) link
+ * updates; removed nodes are recycled through a free chain, and the
+ * pool doubles when exhausted, so there is no fixed block limit.
+ *
+ * Nodes are addressed by uint32_t handle (0 = none). Handles stay valid
+ * until the node is removed; block_t pointers are only valid until the
+ * next insert, which may move the pool.
+ */
+
+typedef struct {
+    block_t  blk;
+    uint32_t prev;
+    uint32_t next;
+} bstore_node_t;
+
+typedef struct {
+    bstore_node_t *nodes;     /* slot 0 is the nil node */
+    uint32_t       cap;
+    uint32_t       used;
+    uint32_t       free_head; /* recycled slots, chained through next */
+    uint32_t       head;
+    uint32_t       tail;
+    size_t         count;
+} block_store_t;
+
+/* lifecycle */
+void bstore_reset(block_store_t *bs);
+void bstore_destroy(block_store_t *bs);
+
+/* insert after 'at' (0 = at head); returns new handle or 0 on OOM */
+uint32_t bstore_insert_after(block_store_t *bs, uint32_t at, const block_t *b);
+void     bstore_remove(block_store_t *bs, uint32_t h);
+
+static inline block_t *bstore_get(const block_store_t *bs, uint32_t h)
+{
+    return &bs->nodes[h].blk;
+}
+
+static inline uint32_t bstore_next(const block_store_t *bs, uint32_t h)
+{
+    return bs->nodes[h].next;
+}
+
+static inline uint32_t bstore_prev(const block_store_t *bs, uint32_t h)
+{
+    return bs->nodes[h].prev;
+}
+
+#endif /* BLOCK_STORE_H */
@@ -3,222 +3,339 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
-/* Buddy allocator configuration */
-#define MIN_ORDER 5    /* 32 bytes */
-#define MAX_ORDER 22   /* up to 4MB */
-
-/* Free list node */
-typedef struct bnode {
-    struct bnode *next;
-} bnode_t;
-
-/* Header stored at start of every block */
-typedef struct {
-    uint32_t id;              /* 0 if free */
-    uint32_t order;           /* block size = 2^order */
-    uint32_t requested_size;  /* user requested bytes */
-} buddy_hdr_t;
-
-/* Globals */
-static uint8_t  *buddy_base = NULL;
-static size_t    buddy_size = 0;
-static int       max_order_local = MAX_ORDER;
-static bnode_t **free_lists = NULL;
-static uint32_t  buddy_next_id = 1;
+#define MIN_ORDER BUDDY_MIN_ORDER
+#define MAX_ORDER BUDDY_MAX_ORDER
+
+#define BUDDY_USED   0x80u
+#define ORDER_MASK   0x3fu
+#define NIL          UINT32_MAX
+
+/*
+ * Pair bitmaps: one bit per buddy pair per order, holding
+ * "left is on the free list" XOR "right is on the free list".
+ * Every push/unlink toggles the bit, so when a block is freed a set bit
+ * means its buddy is free at the same order and can be merged in O(1).
+ */
+
+#define GRAN(off) ((uint32_t)((off) >> MIN_ORDER))
 
 /* Determine minimum order for requested size */
-static int order_for_size(size_t bytes)
+static int order_for_size(const buddy_pool_t *bp, size_t bytes)
 {
     int order = MIN_ORDER;
     size_t sz = 1UL << order;
 
-    while (sz < bytes && order <= max_order_local) {
+    while (sz < bytes && order <= bp->max_order) {
         order++;
         sz <<= 1;
     }
-    return (order > max_order_local) ? -1 : order;
+    return (order > bp->max_order) ? -1 : order;
 }
 
-/* Initialize buddy memory pool */
-int buddy_init_pool(uint8_t *base, size_t bytes)
+/* Pair bit of the block at 'off' */
+static int test_pair(const buddy_pool_t *bp, int order, size_t off)
+{
+    size_t bit = bp->pair_base[order] + (off >> (order + 1));
+    return (bp->pair_bits[bit >> 3] >> (bit & 7)) & 1;
+}
+
+static void toggle_pair(buddy_pool_t *bp, int order, size_t off)
+{
+    size_t bit = bp->pair_base[order] + (off >> (order + 1));
+    bp->pair_bits[bit >> 3] ^= (uint8_t)(1u << (bit & 7));
+}
+
+/* Place each order's pair bits for the current max_order; total bits */
+static size_t pair_layout(buddy_pool_t *bp)
 {
-    if (free_lists) {
-        free(free_lists);
-        free_lists = NULL;
+    size_t granules = 1UL << (bp->max_order - MIN_ORDER);
+    size_t bits = 0;
+
+    for (int k = MIN_ORDER; k < bp->max_order; k++) {
+        bp->pair_base[k] = bits;
+        bits += granules >> (k + 1 - MIN_ORDER);
     }
+    return bits;
+}
 
-    buddy_base = base;
-    buddy_size = bytes;
+/* Initialize buddy memory pool */
+int buddy_init_pool(buddy_pool_t *bp, uint8_t *base, size_t bytes)
+{
+    buddy_shutdown_pool(bp);
+
+    if (!base || bytes < (1UL << MIN_ORDER))
+        return -1;
 
     int o = MIN_ORDER;
-    while ((1UL << (o + 1)) <= buddy_size && o < MAX_ORDER)
+    while ((1UL << (o + 1)) <= bytes && o < MAX_ORDER)
         o++;
 
-    max_order_local = o;
+    bp->max_order = o;
+
+    /* Only the largest power-of-two prefix is managed */
+    size_t granules = 1UL << (bp->max_order - MIN_ORDER);
+    size_t bits = pair_layout(bp);
+
+    bp->gran_state = calloc(granules, sizeof(uint8_t));
+    bp->free_next  = malloc(granules * sizeof(uint32_t));
+    bp->free_prev  = malloc(granules * sizeof(uint32_t));
+    bp->pair_bits  = calloc(bits / 8 + 1, 1);
 
-    free_lists = calloc(max_order_local + 1, sizeof(bnode_t *));
-    if (!free_lists)
+    if (!bp->gran_state || !bp->free_next || !bp->free_prev || !bp->pair_bits) {
+        buddy_shutdown_pool(bp);
         return -1;
+    }
+
+    bp->base = base;
+    bp->size = 1UL << bp->max_order;
 
-    buddy_hdr_t *root = (buddy_hdr_t *)buddy_base;
-    root->id = 0;
-    root->order = max_order_local;
-    root->requested_size = 0;
+    for (int k = 0; k <= MAX_ORDER; k++)
+        bp->free_heads[k] = NIL;
 
-    free_lists[max_order_local] = (bnode_t *)buddy_base;
-    free_lists[max_order_local]->next = NULL;
+    bp->gran_state[0] = (uint8_t)bp->max_order;
+    bp->free_next[0] = bp->free_prev[0] = NIL;
+    bp->free_heads[bp->max_order] = 0;
 
-    buddy_next_id = 1;
+    ididx_reset(&bp->ids);
+    bp->next_id = 1;
     return 0;
 }
 
 /* Shutdown buddy pool */
-void buddy_shutdown_pool(void)
+void buddy_shutdown_pool(buddy_pool_t *bp)
 {
-    if (free_lists) {
-        free(free_lists);
-        free_lists = NULL;
-    }
-    buddy_base = NULL;
-    buddy_size = 0;
+    free(bp->gran_state);
+    free(bp->free_next);
+    free(bp->free_prev);
+    free(bp->pair_bits);
+    ididx_destroy(&bp->ids);
+    memset(bp, 0, sizeof(*bp));
 }
 
-/* Pop block from free list */
-static bnode_t *pop_block(int order)
+/* Unlink block from its free list (O(1)) */
+static void unlink_block(buddy_pool_t *bp, int order, size_t off)
 {
-    bnode_t *b = free_lists[order];
-    if (!b)
-        return NULL;
-    free_lists[order] = b->next;
-    b->next = NULL;
-    return b;
+    uint32_t g = GRAN(off);
+
+    if (bp->free_prev[g] != NIL)
+        bp->free_next[bp->free_prev[g]] = bp->free_next[g];
+    else
+        bp->free_heads[order] = bp->free_next[g];
+    if (bp->free_next[g] != NIL)
+        bp->free_prev[bp->free_next[g]] = bp->free_prev[g];
+
+    if (order < bp->max_order)
+        toggle_pair(bp, order, off);
 }
 
-/* Push block into free list */
-static void push_block(int order, bnode_t *b)
+/* Push block into free list, marking it free */
+static void push_block(buddy_pool_t *bp, int order, size_t off)
 {
-    b->next = free_lists[order];
-    free_lists[order] = b;
+    uint32_t g = GRAN(off);
+
+    bp->gran_state[g] = (uint8_t)order;
+
+    bp->free_prev[g] = NIL;
+    bp->free_next[g] = bp->free_heads[order];
+    if (bp->free_next[g] != NIL)
+        bp->free_prev[bp->free_next[g]] = g;
+    bp->free_heads[order] = g;
+
+    if (order < bp->max_order)
+        toggle_pair(bp, order, off);
+}
+
+/* Pop block from free list; returns its offset or -1 */
+static long pop_block(buddy_pool_t *bp, int order)
+{
+    uint32_t g = bp->free_heads[order];
+    if (g == NIL)
+        return -1;
+
+    size_t off = (size_t)g << MIN_ORDER;
+    unlink_block(bp, order, off);
+    return (long)off;
 }
 
 /* Split block into two buddies */
-static void split_block(int from)
+static void split_block(buddy_pool_t *bp, int from)
 {
-    bnode_t *b = pop_block(from);
-    if (!b)
+    long off = pop_block(bp, from);
+    if (off < 0)
         return;
 
-    size_t sz = 1UL << from;
-    uint8_t *addr = (uint8_t *)b;
+    size_t half = 1UL << (from - 1);
 
-    bnode_t *left  = (bnode_t *)addr;
-    bnode_t *right = (bnode_t *)(addr + (sz >> 1));
+    push_block(bp, from - 1, (size_t)off + half);
+    push_block(bp, from - 1, (size_t)off);
+}
 
-    buddy_hdr_t *hl = (buddy_hdr_t *)left;
-    buddy_hdr_t *hr = (buddy_hdr_t *)right;
+/* Return a free block, merging upward while its buddy is free at the
+   same order */
+static void release_block(buddy_pool_t *bp, int order, size_t off)
+{
+    while (order < bp->max_order && test_pair(bp, order, off)) {
+        size_t buddy = off ^ (1UL << order);
+        unlink_block(bp, order, buddy);
 
-    hl->id = hr->id = 0;
-    hl->requested_size = hr->requested_size = 0;
-    hl->order = hr->order = from - 1;
+        off &= ~(1UL << order);
+        order++;
+    }
 
-    push_block(from - 1, right);
-    push_block(from - 1, left);
+    push_block(bp, order, off);
 }
 
 /* Allocate memory */
-uint32_t buddy_alloc(size_t bytes)
+uint32_t buddy_alloc(buddy_pool_t *bp, size_t bytes)
 {
-    if (!buddy_base || bytes == 0)
+    if (!bp->base || bytes == 0)
         return 0;
 
-    int want = order_for_size(bytes);
+    int want = order_for_size(bp, bytes);
     if (want < 0)
         return 0;
 
     int i = want;
-    while (i <= max_order_local && !free_lists[i])
+    while (i <= bp->max_order && bp->free_heads[i] == NIL)
         i++;
-    if (i > max_order_local)
+    if (i > bp->max_order)
         return 0;
 
     while (i > want) {
-        split_block(i);
+        split_block(bp, i);
         i--;
     }
 
-    bnode_t *b = pop_block(want);
-    if (!b)
+    long off = pop_block(bp, want);
+    if (off < 0)
         return 0;
 
-    buddy_hdr_t *hdr = (buddy_hdr_t *)b;
-    hdr->id = buddy_next_id++;
-    hdr->order = want;
-    hdr->requested_size = bytes;
+    /* the split halves are merged back, as if freed */
+    uint32_t id = bp->next_id;
+    if (ididx_put(&bp->ids, id, (size_t)off, bytes, 0) < 0) {
+        release_block(bp, want, (size_t)off);
+        return 0;
+    }
+    bp->next_id++;
 
-    return hdr->id;
+    bp->gran_state[GRAN(off)] = (uint8_t)(want | BUDDY_USED);
+    return id;
 }
 
 /* Free allocated block */
-int buddy_free(uint32_t id)
+int buddy_free(buddy_pool_t *bp, uint32_t id)
 {
-    if (!buddy_base)
+    if (!bp->base)
         return -1;
 
-    uintptr_t cur = (uintptr_t)buddy_base;
-    uintptr_t end = cur + buddy_size;
+    const ididx_entry_t *e = ididx_get(&bp->ids, id);
+    if (!e)
+        return -1;
 
-    while (cur < end) {
-        buddy_hdr_t *hdr = (buddy_hdr_t *)cur;
-        size_t block_size = 1UL << hdr->order;
+    size_t off = e->offset;
+    int order = bp->gran_state[GRAN(off)] & ORDER_MASK;
+    ididx_del(&bp->ids, id);
 
-        if (hdr->id == id) {
-            hdr->id = 0;
-            hdr->requested_size = 0;
-            push_block(hdr->order, (bnode_t *)hdr);
-            return 0;
-        }
-        cur += block_size;
-    }
-    return -1;
+    release_block(bp, order, off);
+    return 0;
 }
 
-/* Return payload address for allocation ID */
-void *buddy_allocated_address(uint32_t id)
+/* Double the managed size; the arena must already span it */
+int buddy_grow(buddy_pool_t *bp)
 {
-    uintptr_t cur = (uintptr_t)buddy_base;
-    uintptr_t end = cur + buddy_size;
+    if (!bp->base || bp->max_order >= MAX_ORDER)
+        return -1;
 
-    while (cur < end) {
-        buddy_hdr_t *hdr = (buddy_hdr_t *)cur;
-        size_t block_size = 1UL << hdr->order;
+    int old = bp->max_order;
+    size_t half = 1UL << (old - MIN_ORDER);      /* granules today */
 
-        if (hdr->id == id)
-            return (void *)(cur + sizeof(buddy_hdr_t));
+    uint8_t *st = realloc(bp->gran_state, 2 * half * sizeof(uint8_t));
+    if (!st)
+        return -1;
+    bp->gran_state = st;
+    memset(st + half, 0, half);
 
-        cur += block_size;
+    uint32_t *nx = realloc(bp->free_next, 2 * half * sizeof(uint32_t));
+    if (!nx)
+        return -1;
+    bp->free_next = nx;
+
+    uint32_t *pv = realloc(bp->free_prev, 2 * half * sizeof(uint32_t));
+    if (!pv)
+        return -1;
+    bp->free_prev = pv;
+
+    /* the pair bitmaps are laid out by max_order: rebuild them from the
+       free lists (each free block toggles its pair once) */
+    bp->max_order = old + 1;
+    size_t bits = pair_layout(bp);
+    uint8_t *pairs = calloc(bits / 8 + 1, 1);
+    if (!pairs) {
+        bp->max_order = old;
+        pair_layout(bp);
+        return -1;
     }
-    return NULL;
+    free(bp->pair_bits);
+    bp->pair_bits = pairs;
+
+    for (int k = MIN_ORDER; k <= old; k++) {
+        for (uint32_t g = bp->free_heads[k]; g != NIL; g = bp->free_next[g])
+            toggle_pair(bp, k, (size_t)g << MIN_ORDER);
+    }
+
+    bp->size = 1UL << bp->max_order;
+
+    /* the new upper half merges with the old pool if that is all free */
+    release_block(bp, old, (size_t)1 << old);
+    return 0;
+}
+
+/* Return payload address for allocation ID */
+void *buddy_allocated_address(const buddy_pool_t *bp, uint32_t id)
+{
+    const ididx_entry_t *e = ididx_get(&bp->ids, id);
+    if (!bp->base || !e)
+        return NULL;
+
+    return bp->base + e->offset;
 }
 
 /* Return requested allocation size */
-size_t buddy_allocated_size(uint32_t id)
+size_t buddy_allocated_size(const buddy_pool_t *bp, uint32_t id)
 {
-    uintptr_t cur = (uintptr_t)buddy_base;
-    uintptr_t end = cur + buddy_size;
+    const ididx_entry_t *e = ididx_get(&bp->ids, id);
+    return e ? e->requested_size : 0;
+}
 
-    while (cur < end) {
-        buddy_hdr_t *hdr = (buddy_hdr_t *)cur;
-        size_t block_size = 1UL << hdr->order;
+/* Reverse lookup: payload address -> allocation ID */
+uint32_t buddy_address_to_id(const buddy_pool_t *bp, const void *ptr)
+{
+    const uint8_t *p = ptr;
 
-        if (hdr->id == id)
-            return hdr->requested_size;
+    if (!bp->base || p < bp->base || p >= bp->base + bp->size)
+        return 0;
 
-        cur += block_size;
-    }
+    return ididx_id_at(&bp->ids, (size_t)(p - bp->base));
+}
+
+/* Describe the block starting at 'offset' (dump / stats iteration) */
+int buddy_block_at(const buddy_pool_t *bp, size_t offset, block_t *out)
+{
+    if (!bp->base || offset >= bp->size)
+        return -1;
+
+    uint8_t st = bp->gran_state[GRAN(offset)];
+
+    out->offset = offset;
+    out->size = 1UL << (st & ORDER_MASK);
+    out->free = !(st & BUDDY_USED);
+    out->id = out->free ? 0 : ididx_id_at(&bp->ids, offset);
+    out->requested_size = out->free ? 0 : buddy_allocated_size(bp, out->id);
     return 0;
 }
 
 /* Read-only accessors for dump / stats */
-uint8_t *buddy_get_base(void) { return buddy_base; }
-size_t   buddy_get_size(void) { return buddy_size; }
+uint8_t *buddy_get_base(const buddy_pool_t *bp) { return bp->base; }
+size_t   buddy_get_size(const buddy_pool_t *bp) { return bp->size; }
@@ -4,20 +4,63 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "allocator.h"
+#include "id_index.h"
+
+/* Buddy allocator configuration */
+#define BUDDY_MIN_ORDER 5    /* 32 bytes */
+#define BUDDY_MAX_ORDER 22   /* up to 4MB */
+
+/*
+ * Out-of-band metadata, indexed by granule (2^BUDDY_MIN_ORDER bytes).
+ * The heap holds only payload.
+ *
+ *   gran_state[g]  order of the block starting at granule g, plus
+ *                  BUDDY_USED if allocated (only meaningful at block starts)
+ *   free_next/prev doubly linked free lists threaded through granules
+ *   ids            allocation ID <-> offset, requested size
+ *
+ * One pool per heap; every call takes the pool it works on.
+ */
+typedef struct buddy_pool {
+    uint8_t   *base;
+    size_t     size;
+    int        max_order;
+    uint8_t   *gran_state;
+    uint32_t  *free_next;
+    uint32_t  *free_prev;
+    uint32_t   free_heads[BUDDY_MAX_ORDER + 1];
+    uint8_t   *pair_bits;
+    size_t     pair_base[BUDDY_MAX_ORDER + 1];  /* first bit of each order */
+    uint32_t   next_id;
+    id_index_t ids;
+} buddy_pool_t;
+
 /* lifecycle */
-int  buddy_init_pool(uint8_t *base, size_t bytes);
-void buddy_shutdown_pool(void);
+int  buddy_init_pool(buddy_pool_t *bp, uint8_t *base, size_t bytes);
+void buddy_shutdown_pool(buddy_pool_t *bp);
 
 /* allocation */
-uint32_t buddy_alloc(size_t bytes);
-int      buddy_free(uint32_t id);
+uint32_t buddy_alloc(buddy_pool_t *bp, size_t bytes);
+int      buddy_free(buddy_pool_t *bp, uint32_t id);
+
+/* Double the pool (up to 2^BUDDY_MAX_ORDER); the memory past the old
+   size must already belong to the heap. 0 or -1 */
+int      buddy_grow(buddy_pool_t *bp);
 
 /* helpers for CLI & stats */
-void    *buddy_allocated_address(uint32_t id);
-size_t   buddy_allocated_size(uint32_t id);
+void    *buddy_allocated_address(const buddy_pool_t *bp, uint32_t id);
+size_t   buddy_allocated_size(const buddy_pool_t *bp, uint32_t id);
+uint32_t buddy_address_to_id(const buddy_pool_t *bp, const void *ptr);
+
+/*
+ * Out-of-band block view for dump & stats, in address order:
+ *   for (off = 0; buddy_block_at(bp, off, &b) == 0; off += b.size)
+ */
+int buddy_block_at(const buddy_pool_t *bp, size_t offset, block_t *out);
 
 /* read-only accessors */
-uint8_t *buddy_get_base(void);
-size_t   buddy_get_size(void);
+uint8_t *buddy_get_base(const buddy_pool_t *bp);
+size_t   buddy_get_size(const buddy_pool_t *bp);
 
 #endif /* BUDDY_H */
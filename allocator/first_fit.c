@@ -3,16 +3,15 @@
 
 /*
  * First-fit on out-of-band metadata
- * Returns index of first suitable block, or -1
+ * Answered by the free-space index in O(log n)
+ * Returns block-store handle of first suitable block, or -1
  */
 
-int ff_find(size_t req) {
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
+int ff_find(mem_heap_t *heap, size_t req) {
+    uint32_t h;
 
-    for (size_t i = 0; i < count; i++) {
-        if (blocks[i].free && blocks[i].size >= req)
-            return (int)i;
-    }
-    return -1;
+    if (fidx_first_fit(allocator_get_free_index(heap), req, &h) < 0)
+        return -1;
+
+    return (int)h;
 }
@@ -3,10 +3,12 @@
 
 #include <stddef.h>
 
+#include "allocator.h"
+
 /*
  * First-fit allocator (out-of-band metadata)
- * Returns index of first suitable free block, or -1
+ * Returns block-store handle of first suitable free block, or -1
  */
-int ff_find(size_t req);
+int ff_find(mem_heap_t *heap, size_t req);
 
 #endif /* FIRST_FIT_H */
@@ -0,0 +1,354 @@
+#include "free_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NIL 0u
+
+/* ================= NODE POOL ================= */
+
+static uint32_t node_new(free_index_t *fx)
+{
+    if (fx->free_head != NIL) {
+        uint32_t n = fx->free_head;
+        fx->free_head = fx->nodes[n].left[0];
+        return n;
+    }
+
+    if (fx->used >= fx->cap) {
+        uint32_t cap = fx->cap ? fx->cap * 2 : 64;
+        fidx_node_t *p = realloc(fx->nodes, cap * sizeof(fidx_node_t));
+        if (!p)
+            return NIL;
+        fx->nodes = p;
+        fx->cap = cap;
+    }
+    return fx->used++;
+}
+
+static void node_release(free_index_t *fx, uint32_t n)
+{
+    fx->nodes[n].left[0] = fx->free_head;
+    fx->free_head = n;
+}
+
+/* ================= AVL HELPERS ================= */
+
+static int cmp_key(const free_index_t *fx, int t,
+                   size_t size, size_t offset, uint32_t n)
+{
+    const fidx_node_t *x = &fx->nodes[n];
+
+    if (t == FIDX_BY_SIZE && size != x->size)
+        return size < x->size ? -1 : 1;
+    if (offset != x->offset)
+        return offset < x->offset ? -1 : 1;
+    return 0;
+}
+
+static int height(const free_index_t *fx, int t, uint32_t n)
+{
+    return n ? fx->nodes[n].height[t] : 0;
+}
+
+static void update(free_index_t *fx, int t, uint32_t n)
+{
+    fidx_node_t *x = &fx->nodes[n];
+    int hl = height(fx, t, x->left[t]);
+    int hr = height(fx, t, x->right[t]);
+
+    x->height[t] = (uint8_t)(1 + (hl > hr ? hl : hr));
+
+    if (t == FIDX_BY_OFFSET) {
+        size_t m = x->size;
+        if (x->left[t] && fx->nodes[x->left[t]].max_size > m)
+            m = fx->nodes[x->left[t]].max_size;
+        if (x->right[t] && fx->nodes[x->right[t]].max_size > m)
+            m = fx->nodes[x->right[t]].max_size;
+        x->max_size = m;
+    }
+}
+
+static uint32_t rotate_right(free_index_t *fx, int t, uint32_t n)
+{
+    uint32_t l = fx->nodes[n].left[t];
+    fx->nodes[n].left[t] = fx->nodes[l].right[t];
+    fx->nodes[l].right[t] = n;
+    update(fx, t, n);
+    update(fx, t, l);
+    return l;
+}
+
+static uint32_t rotate_left(free_index_t *fx, int t, uint32_t n)
+{
+    uint32_t r = fx->nodes[n].right[t];
+    fx->nodes[n].right[t] = fx->nodes[r].left[t];
+    fx->nodes[r].left[t] = n;
+    update(fx, t, n);
+    update(fx, t, r);
+    return r;
+}
+
+static uint32_t balance(free_index_t *fx, int t, uint32_t n)
+{
+    fidx_node_t *x = &fx->nodes[n];
+    int bf;
+
+    update(fx, t, n);
+    bf = height(fx, t, x->left[t]) - height(fx, t, x->right[t]);
+
+    if (bf > 1) {
+        uint32_t l = x->left[t];
+        if (height(fx, t, fx->nodes[l].left[t]) <
+            height(fx, t, fx->nodes[l].right[t]))
+            x->left[t] = rotate_left(fx, t, l);
+        return rotate_right(fx, t, n);
+    }
+    if (bf < -1) {
+        uint32_t r = x->right[t];
+        if (height(fx, t, fx->nodes[r].right[t]) <
+            height(fx, t, fx->nodes[r].left[t]))
+            x->right[t] = rotate_right(fx, t, r);
+        return rotate_left(fx, t, n);
+    }
+    return n;
+}
+
+static uint32_t tree_insert(free_index_t *fx, int t, uint32_t root, uint32_t n)
+{
+    if (!root)
+        return n;
+
+    if (cmp_key(fx, t, fx->nodes[n].size, fx->nodes[n].offset, root) < 0)
+        fx->nodes[root].left[t] = tree_insert(fx, t, fx->nodes[root].left[t], n);
+    else
+        fx->nodes[root].right[t] = tree_insert(fx, t, fx->nodes[root].right[t], n);
+
+    return balance(fx, t, root);
+}
+
+/* Detach the minimum of a subtree; *min receives it */
+static uint32_t tree_remove_min(free_index_t *fx, int t, uint32_t root,
+                                uint32_t *min)
+{
+    if (!fx->nodes[root].left[t]) {
+        *min = root;
+        return fx->nodes[root].right[t];
+    }
+    fx->nodes[root].left[t] =
+        tree_remove_min(fx, t, fx->nodes[root].left[t], min);
+    return balance(fx, t, root);
+}
+
+static uint32_t tree_remove(free_index_t *fx, int t, uint32_t root,
+                            size_t size, size_t offset, uint32_t *found)
+{
+    if (!root)
+        return NIL;
+
+    int c = cmp_key(fx, t, size, offset, root);
+
+    if (c < 0) {
+        fx->nodes[root].left[t] =
+            tree_remove(fx, t, fx->nodes[root].left[t], size, offset, found);
+    } else if (c > 0) {
+        fx->nodes[root].right[t] =
+            tree_remove(fx, t, fx->nodes[root].right[t], size, offset, found);
+    } else {
+        uint32_t l = fx->nodes[root].left[t];
+        uint32_t r = fx->nodes[root].right[t];
+        uint32_t m;
+
+        *found = root;
+        if (!l || !r)
+            return l ? l : r;
+
+        r = tree_remove_min(fx, t, r, &m);
+        fx->nodes[m].left[t] = l;
+        fx->nodes[m].right[t] = r;
+        return balance(fx, t, m);
+    }
+    return balance(fx, t, root);
+}
+
+/* ================= LIFECYCLE ================= */
+
+void fidx_reset(free_index_t *fx)
+{
+    if (!fx->nodes) {
+        memset(fx, 0, sizeof(*fx));
+    }
+    fx->used = 1;               /* slot 0 is nil */
+    fx->free_head = NIL;
+    fx->root[0] = fx->root[1] = NIL;
+    fx->count = 0;
+}
+
+void fidx_destroy(free_index_t *fx)
+{
+    free(fx->nodes);
+    memset(fx, 0, sizeof(*fx));
+}
+
+/* ================= MAINTENANCE ================= */
+
+int fidx_insert(free_index_t *fx, size_t offset, size_t size, uint32_t ref)
+{
+    uint32_t n = node_new(fx);
+    if (n == NIL)
+        return -1;
+
+    fidx_node_t *x = &fx->nodes[n];
+    memset(x, 0, sizeof(*x));
+    x->offset = offset;
+    x->size = size;
+    x->max_size = size;
+    x->ref = ref;
+    x->height[0] = x->height[1] = 1;
+
+    fx->root[FIDX_BY_OFFSET] = tree_insert(fx, FIDX_BY_OFFSET, fx->root[FIDX_BY_OFFSET], n);
+    fx->root[FIDX_BY_SIZE]   = tree_insert(fx, FIDX_BY_SIZE, fx->root[FIDX_BY_SIZE], n);
+    fx->count++;
+    return 0;
+}
+
+void fidx_remove(free_index_t *fx, size_t offset, size_t size)
+{
+    uint32_t a = NIL, b = NIL;
+
+    fx->root[FIDX_BY_OFFSET] =
+        tree_remove(fx, FIDX_BY_OFFSET, fx->root[FIDX_BY_OFFSET], size, offset, &a);
+    fx->root[FIDX_BY_SIZE] =
+        tree_remove(fx, FIDX_BY_SIZE, fx->root[FIDX_BY_SIZE], size, offset, &b);
+
+    if (a != NIL) {
+        node_release(fx, a);
+        fx->count--;
+    }
+}
+
+/* ================= QUERIES ================= */
+
+int fidx_first_fit(const free_index_t *fx, size_t req, uint32_t *ref)
+{
+    const int t = FIDX_BY_OFFSET;
+    uint32_t n = fx->root[t];
+
+    if (!n || fx->nodes[n].max_size < req)
+        return -1;
+
+    while (n) {
+        const fidx_node_t *x = &fx->nodes[n];
+
+        if (x->left[t] && fx->nodes[x->left[t]].max_size >= req)
+            n = x->left[t];
+        else if (x->size >= req) {
+            *ref = x->ref;
+            return 0;
+        } else
+            n = x->right[t];
+    }
+    return -1;
+}
+
+/* Lowest-offset node at or after 'from' with size >= req */
+static uint32_t first_fit_from(const free_index_t *fx, uint32_t n,
+                               size_t req, size_t from)
+{
+    const int t = FIDX_BY_OFFSET;
+
+    while (n && fx->nodes[n].max_size >= req) {
+        const fidx_node_t *x = &fx->nodes[n];
+
+        if (x->offset < from) {
+            n = x->right[t];
+            continue;
+        }
+
+        uint32_t l = first_fit_from(fx, x->left[t], req, from);
+        if (l)
+            return l;
+        if (x->size >= req)
+            return n;
+        n = x->right[t];
+    }
+    return NIL;
+}
+
+int fidx_next_fit(const free_index_t *fx, size_t req, size_t rover, uint32_t *ref)
+{
+    const int t = FIDX_BY_OFFSET;
+    uint32_t n = fx->root[t];
+    uint32_t at = NIL;
+
+    /* free block containing the rover, if any (it may have coalesced) */
+    while (n) {
+        if (fx->nodes[n].offset <= rover) {
+            at = n;
+            n = fx->nodes[n].right[t];
+        } else {
+            n = fx->nodes[n].left[t];
+        }
+    }
+    if (at && fx->nodes[at].offset + fx->nodes[at].size > rover &&
+        fx->nodes[at].size >= req) {
+        *ref = fx->nodes[at].ref;
+        return 0;
+    }
+
+    /* then onward to the end of the heap, then wrap to the start */
+    n = first_fit_from(fx, fx->root[t], req, rover + 1);
+    if (n) {
+        *ref = fx->nodes[n].ref;
+        return 0;
+    }
+    return fidx_first_fit(fx, req, ref);
+}
+
+/* Smallest (size, offset) with size >= req */
+static uint32_t lower_bound(const free_index_t *fx, size_t req)
+{
+    const int t = FIDX_BY_SIZE;
+    uint32_t n = fx->root[t];
+    uint32_t best = NIL;
+
+    while (n) {
+        if (fx->nodes[n].size >= req) {
+            best = n;
+            n = fx->nodes[n].left[t];
+        } else {
+            n = fx->nodes[n].right[t];
+        }
+    }
+    return best;
+}
+
+int fidx_best_fit(const free_index_t *fx, size_t req, uint32_t *ref)
+{
+    uint32_t n = lower_bound(fx, req);
+    if (!n)
+        return -1;
+
+    *ref = fx->nodes[n].ref;
+    return 0;
+}
+
+int fidx_worst_fit(const free_index_t *fx, size_t req, uint32_t *ref)
+{
+    const int t = FIDX_BY_SIZE;
+    uint32_t n = fx->root[t];
+
+    if (!n)
+        return -1;
+
+    while (fx->nodes[n].right[t])
+        n = fx->nodes[n].right[t];
+
+    if (fx->nodes[n].size < req)
+        return -1;
+
+    /* lowest offset among the largest blocks */
+    n = lower_bound(fx, fx->nodes[n].size);
+    *ref = fx->nodes[n].ref;
+    return 0;
+}
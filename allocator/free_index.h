@@ -0,0 +1,58 @@
+#ifndef FREE_INDEX_H
+#define FREE_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Free-space index for the FIT allocators.
+ *
+ * Every free block_t is mirrored here as one pooled node that sits in
+ * two balanced (AVL) trees at once:
+ *   - by offset, augmented with the largest size in each subtree,
+ *     which answers first-fit and next-fit in O(log n)
+ *   - by (size, offset), which answers best-fit and worst-fit in O(log n)
+ *
+ * Ties are broken by lowest offset, so placement is identical to a
+ * linear scan over the offset-sorted block list.
+ */
+
+#define FIDX_BY_OFFSET 0
+#define FIDX_BY_SIZE   1
+
+typedef struct {
+    size_t   offset;
+    size_t   size;
+    size_t   max_size;      /* largest size in by-offset subtree */
+    uint32_t ref;           /* owner's handle for the block */
+    uint32_t left[2];
+    uint32_t right[2];
+    uint8_t  height[2];
+} fidx_node_t;
+
+typedef struct {
+    fidx_node_t *nodes;     /* node pool, slot 0 is the nil node */
+    uint32_t     cap;
+    uint32_t     used;
+    uint32_t     free_head; /* recycled slots, chained through left[0] */
+    uint32_t     root[2];
+    size_t       count;
+} free_index_t;
+
+/* lifecycle */
+void fidx_reset(free_index_t *fx);
+void fidx_destroy(free_index_t *fx);
+
+/* maintenance (called on split / coalesce) */
+int  fidx_insert(free_index_t *fx, size_t offset, size_t size, uint32_t ref);
+void fidx_remove(free_index_t *fx, size_t offset, size_t size);
+
+/* queries: return 0 and set *ref, or -1 if nothing fits */
+int fidx_first_fit(const free_index_t *fx, size_t req, uint32_t *ref);
+int fidx_best_fit(const free_index_t *fx, size_t req, uint32_t *ref);
+int fidx_worst_fit(const free_index_t *fx, size_t req, uint32_t *ref);
+
+/* first fit starting at the block holding 'rover', wrapping to offset 0 */
+int fidx_next_fit(const free_index_t *fx, size_t req, size_t rover, uint32_t *ref);
+
+#endif /* FREE_INDEX_H */
@@ -0,0 +1,204 @@
+#include "id_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define IDIDX_MIN_CAP 64
+
+/* ================= HASHING ================= */
+
+static size_t hash_u64(uint64_t k, size_t mask)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return (size_t)k & mask;
+}
+
+/* True if slot i lies cyclically in [home, j) (i.e. entry at j may move to i) */
+static int can_shift(size_t home, size_t i, size_t j)
+{
+    if (i <= j)
+        return home <= i || home > j;
+    return home <= i && home > j;
+}
+
+/* ================= RAW TABLE OPS ================= */
+
+/* Returns 1 if the entry filled an empty slot, 0 if it replaced its ID */
+static int put_id(ididx_entry_t *t, size_t mask, const ididx_entry_t *e)
+{
+    size_t i = hash_u64(e->id, mask);
+
+    while (t[i].id && t[i].id != e->id)
+        i = (i + 1) & mask;
+
+    int fresh = t[i].id == 0;
+    t[i] = *e;
+    return fresh;
+}
+
+static void put_addr(ididx_addr_t *t, size_t mask, size_t offset, uint32_t id)
+{
+    size_t i = hash_u64(offset, mask);
+
+    while (t[i].id && t[i].offset != offset)
+        i = (i + 1) & mask;
+    t[i].offset = offset;
+    t[i].id = id;
+}
+
+static void del_addr(ididx_addr_t *t, size_t mask, size_t offset)
+{
+    size_t i = hash_u64(offset, mask);
+
+    while (t[i].id && t[i].offset != offset)
+        i = (i + 1) & mask;
+    if (!t[i].id)
+        return;
+
+    /* backward-shift delete */
+    for (size_t j = (i + 1) & mask; t[j].id; j = (j + 1) & mask) {
+        if (can_shift(hash_u64(t[j].offset, mask), i, j)) {
+            t[i] = t[j];
+            i = j;
+        }
+    }
+    t[i].id = 0;
+}
+
+static int grow(id_index_t *ix)
+{
+    size_t cap = ix->cap ? ix->cap * 2 : IDIDX_MIN_CAP;
+    ididx_entry_t *by_id = calloc(cap, sizeof(*by_id));
+    ididx_addr_t  *by_addr = calloc(cap, sizeof(*by_addr));
+
+    if (!by_id || !by_addr) {
+        free(by_id);
+        free(by_addr);
+        return -1;
+    }
+
+    for (size_t i = 0; i < ix->cap; i++) {
+        if (ix->by_id[i].id)
+            put_id(by_id, cap - 1, &ix->by_id[i]);
+        if (ix->by_addr[i].id)
+            put_addr(by_addr, cap - 1, ix->by_addr[i].offset, ix->by_addr[i].id);
+    }
+
+    free(ix->by_id);
+    free(ix->by_addr);
+    ix->by_id = by_id;
+    ix->by_addr = by_addr;
+    ix->cap = cap;
+    return 0;
+}
+
+/* ================= LIFECYCLE ================= */
+
+void ididx_reset(id_index_t *ix)
+{
+    if (ix->cap) {
+        memset(ix->by_id, 0, ix->cap * sizeof(*ix->by_id));
+        memset(ix->by_addr, 0, ix->cap * sizeof(*ix->by_addr));
+    }
+    ix->count = 0;
+}
+
+void ididx_destroy(id_index_t *ix)
+{
+    free(ix->by_id);
+    free(ix->by_addr);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/* ================= MAINTENANCE ================= */
+
+int ididx_put(id_index_t *ix, uint32_t id, size_t offset,
+              size_t requested_size, uint32_t ref)
+{
+    if (id == 0)
+        return -1;
+
+    const ididx_entry_t *old = ididx_get(ix, id);
+
+    /* keep load factor <= 1/2; replacing an entry adds nothing */
+    if (!old && (ix->count + 1) * 2 > ix->cap && grow(ix) < 0)
+        return -1;
+
+    /* a moved entry must not leave its old address behind */
+    if (old && old->offset != offset)
+        del_addr(ix->by_addr, ix->cap - 1, old->offset);
+
+    ididx_entry_t e = { .id = id, .offset = offset,
+                        .requested_size = requested_size, .ref = ref };
+
+    if (put_id(ix->by_id, ix->cap - 1, &e))
+        ix->count++;
+    put_addr(ix->by_addr, ix->cap - 1, offset, id);
+    return 0;
+}
+
+void ididx_del(id_index_t *ix, uint32_t id)
+{
+    if (!ix->cap || id == 0)
+        return;
+
+    size_t mask = ix->cap - 1;
+    size_t i = hash_u64(id, mask);
+
+    while (ix->by_id[i].id && ix->by_id[i].id != id)
+        i = (i + 1) & mask;
+    if (!ix->by_id[i].id)
+        return;
+
+    size_t offset = ix->by_id[i].offset;
+
+    /* backward-shift delete in the ID table */
+    for (size_t j = (i + 1) & mask; ix->by_id[j].id; j = (j + 1) & mask) {
+        if (can_shift(hash_u64(ix->by_id[j].id, mask), i, j)) {
+            ix->by_id[i] = ix->by_id[j];
+            i = j;
+        }
+    }
+    ix->by_id[i].id = 0;
+
+    /* and in the address table */
+    del_addr(ix->by_addr, mask, offset);
+
+    ix->count--;
+}
+
+/* ================= LOOKUPS ================= */
+
+const ididx_entry_t *ididx_get(const id_index_t *ix, uint32_t id)
+{
+    if (!ix->cap || id == 0)
+        return NULL;
+
+    size_t mask = ix->cap - 1;
+    size_t i = hash_u64(id, mask);
+
+    while (ix->by_id[i].id) {
+        if (ix->by_id[i].id == id)
+            return &ix->by_id[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+uint32_t ididx_id_at(const id_index_t *ix, size_t offset)
+{
+    if (!ix->cap)
+        return 0;
+
+    size_t mask = ix->cap - 1;
+    size_t i = hash_u64(offset, mask);
+
+    while (ix->by_addr[i].id) {
+        if (ix->by_addr[i].offset == offset)
+            return ix->by_addr[i].id;
+        i = (i + 1) & mask;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Allocation index: ID -> (offset, requested size) and offset -> ID.
+ *
+ * Both directions are open-addressing hash tables with linear probing
+ * and backward-shift deletion, so lookups, inserts and removals are
+ * O(1) on average and the tables only grow with the number of live
+ * allocations, never with the highest ID handed out.
+ *
+ * Every allocator keeps one instance in step with its own metadata;
+ * free, ID -> pointer and pointer -> ID all resolve through it.
+ */
+
+typedef struct {
+    uint32_t id;              /* 0 marks an empty slot */
+    size_t   offset;          /* block offset into heap */
+    size_t   requested_size;  /* bytes requested by user */
+    uint32_t ref;             /* owner's handle for the block */
+} ididx_entry_t;
+
+typedef struct {
+    size_t   offset;
+    uint32_t id;              /* 0 marks an empty slot */
+} ididx_addr_t;
+
+typedef struct {
+    ididx_entry_t *by_id;
+    ididx_addr_t  *by_addr;
+    size_t         cap;       /* slots per table, power of two */
+    size_t         count;     /* live allocations */
+} id_index_t;
+
+/* lifecycle */
+void ididx_reset(id_index_t *ix);
+void ididx_destroy(id_index_t *ix);
+
+/* maintenance */
+int  ididx_put(id_index_t *ix, uint32_t id, size_t offset,
+               size_t requested_size, uint32_t ref);
+void ididx_del(id_index_t *ix, uint32_t id);
+
+/* lookups */
+const ididx_entry_t *ididx_get(const id_index_t *ix, uint32_t id);
+uint32_t             ididx_id_at(const id_index_t *ix, size_t offset);
+
+#endif /* ID_INDEX_H */
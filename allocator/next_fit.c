@@ -0,0 +1,19 @@
+#include "next_fit.h"
+#include "allocator.h"
+
+/*
+ * Next-fit on out-of-band metadata
+ * The rover is an offset, not a block, so split and coalesce never
+ * leave it dangling: the search starts at whichever free block now
+ * covers it. Answered by the free-space index in O(log n)
+ * Returns block-store handle of suitable block, or -1
+ */
+
+int nf_find(mem_heap_t *heap, size_t req, size_t rover) {
+    uint32_t h;
+
+    if (fidx_next_fit(allocator_get_free_index(heap), req, rover, &h) < 0)
+        return -1;
+
+    return (int)h;
+}
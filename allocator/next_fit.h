@@ -0,0 +1,15 @@
+#ifndef NEXT_FIT_H
+#define NEXT_FIT_H
+
+#include <stddef.h>
+
+#include "allocator.h"
+
+/*
+ * Next-fit allocator (out-of-band metadata)
+ * Resumes the first-fit search at the rover offset, wrapping to 0
+ * Returns block-store handle of suitable free block, or -1
+ */
+int nf_find(mem_heap_t *heap, size_t req, size_t rover);
+
+#endif /* NEXT_FIT_H */
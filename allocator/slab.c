@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+#include "slab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MIN_CLASS_SHIFT 4      /* 16 bytes */
+#define NIL             UINT32_MAX
+
+/* Per-slab metadata (out-of-band) */
+typedef struct slab_meta {
+    uint64_t free_mask;        /* bit i set = slot i free */
+    uint32_t next;             /* partial list / empty stack link */
+    uint32_t prev;             /* partial list link */
+    int8_t   cls;              /* -1 if empty */
+    uint8_t  used;             /* allocated slots */
+} slab_meta_t;
+
+static size_t class_size(int cls)
+{
+    return (size_t)1 << (cls + MIN_CLASS_SHIFT);
+}
+
+static size_t class_slots(int cls)
+{
+    return SLAB_SIZE / class_size(cls);
+}
+
+/* Smallest class that fits, or -1 */
+static int class_for_size(size_t bytes)
+{
+    for (int c = 0; c < SLAB_NUM_CLASSES; c++) {
+        if (class_size(c) >= bytes)
+            return c;
+    }
+    return -1;
+}
+
+/* Initialize slab pool */
+int slab_init_pool(slab_pool_t *sp, uint8_t *base, size_t bytes)
+{
+    slab_shutdown_pool(sp);
+
+    sp->count = bytes / SLAB_SIZE;
+    if (!base || sp->count == 0)
+        return -1;
+
+    sp->slabs = calloc(sp->count, sizeof(slab_meta_t));
+    if (!sp->slabs)
+        return -1;
+
+    sp->base = base;
+
+    /* every slab starts on the empty stack, lowest address on top */
+    sp->empty_head = NIL;
+    for (size_t i = sp->count; i-- > 0;) {
+        sp->slabs[i].cls = -1;
+        sp->slabs[i].next = sp->empty_head;
+        sp->empty_head = (uint32_t)i;
+    }
+
+    for (int c = 0; c < SLAB_NUM_CLASSES; c++) {
+        sp->partial_head[c] = NIL;
+        sp->class_stats[c] = (slab_class_stats_t){ .obj_size = class_size(c) };
+    }
+
+    ididx_reset(&sp->ids);
+    sp->next_id = 1;
+    return 0;
+}
+
+/* Shutdown slab pool */
+void slab_shutdown_pool(slab_pool_t *sp)
+{
+    free(sp->slabs);
+    ididx_destroy(&sp->ids);
+    memset(sp, 0, sizeof(*sp));
+}
+
+/* Partial list maintenance (O(1)) */
+static void partial_push(slab_pool_t *sp, int cls, uint32_t s)
+{
+    slab_meta_t *slabs = sp->slabs;
+
+    slabs[s].prev = NIL;
+    slabs[s].next = sp->partial_head[cls];
+    if (slabs[s].next != NIL)
+        slabs[slabs[s].next].prev = s;
+    sp->partial_head[cls] = s;
+}
+
+static void partial_unlink(slab_pool_t *sp, int cls, uint32_t s)
+{
+    slab_meta_t *slabs = sp->slabs;
+
+    if (slabs[s].prev != NIL)
+        slabs[slabs[s].prev].next = slabs[s].next;
+    else
+        sp->partial_head[cls] = slabs[s].next;
+    if (slabs[s].next != NIL)
+        slabs[slabs[s].next].prev = slabs[s].prev;
+}
+
+/* Take an empty slab and bind it to a class */
+static uint32_t bind_slab(slab_pool_t *sp, int cls)
+{
+    uint32_t s = sp->empty_head;
+    if (s == NIL)
+        return NIL;
+
+    slab_meta_t *m = &sp->slabs[s];
+    sp->empty_head = m->next;
+
+    size_t n = class_slots(cls);
+    m->cls = (int8_t)cls;
+    m->used = 0;
+    m->free_mask = (n == 64) ? UINT64_MAX : ((1ULL << n) - 1);
+
+    sp->class_stats[cls].slabs++;
+    sp->class_stats[cls].total_slots += n;
+
+    partial_push(sp, cls, s);
+    return s;
+}
+
+/* Return a now-empty slab to the empty stack */
+static void unbind_slab(slab_pool_t *sp, uint32_t s)
+{
+    slab_meta_t *m = &sp->slabs[s];
+    int cls = m->cls;
+
+    sp->class_stats[cls].slabs--;
+    sp->class_stats[cls].total_slots -= class_slots(cls);
+
+    m->cls = -1;
+    m->next = sp->empty_head;
+    sp->empty_head = s;
+}
+
+/* Allocate memory */
+uint32_t slab_alloc(slab_pool_t *sp, size_t bytes)
+{
+    if (!sp->base || bytes == 0)
+        return 0;
+
+    int cls = class_for_size(bytes);
+    if (cls < 0)
+        return 0;
+
+    uint32_t s = sp->partial_head[cls];
+    int bound = 0;
+    if (s == NIL) {
+        s = bind_slab(sp, cls);
+        bound = 1;
+    }
+    if (s == NIL)
+        return 0;
+
+    slab_meta_t *m = &sp->slabs[s];
+    unsigned slot = (unsigned)__builtin_ctzll(m->free_mask);
+    size_t off = (size_t)s * SLAB_SIZE + slot * class_size(cls);
+
+    /* a slab bound for this request goes back to the empty list */
+    uint32_t id = sp->next_id;
+    if (ididx_put(&sp->ids, id, off, bytes, (uint32_t)cls) < 0) {
+        if (bound) {
+            partial_unlink(sp, cls, s);
+            unbind_slab(sp, s);
+        }
+        return 0;
+    }
+    sp->next_id++;
+
+    m->free_mask &= ~(1ULL << slot);
+    m->used++;
+    if (!m->free_mask)
+        partial_unlink(sp, cls, s);
+
+    sp->class_stats[cls].live_objs++;
+    sp->class_stats[cls].requested_bytes += bytes;
+    return id;
+}
+
+/* Free allocated slot */
+int slab_free(slab_pool_t *sp, uint32_t id)
+{
+    if (!sp->base)
+        return -1;
+
+    const ididx_entry_t *e = ididx_get(&sp->ids, id);
+    if (!e)
+        return -1;
+
+    uint32_t s = (uint32_t)(e->offset / SLAB_SIZE);
+    slab_meta_t *m = &sp->slabs[s];
+    int cls = m->cls;
+    unsigned slot = (unsigned)((e->offset % SLAB_SIZE) / class_size(cls));
+    int was_full = (m->free_mask == 0);
+
+    sp->class_stats[cls].live_objs--;
+    sp->class_stats[cls].requested_bytes -= e->requested_size;
+    ididx_del(&sp->ids, id);
+
+    m->free_mask |= 1ULL << slot;
+    m->used--;
+
+    if (m->used == 0) {
+        if (!was_full)
+            partial_unlink(sp, cls, s);
+        unbind_slab(sp, s);
+    } else if (was_full) {
+        partial_push(sp, cls, s);
+    }
+    return 0;
+}
+
+/* Return payload address for allocation ID */
+void *slab_allocated_address(const slab_pool_t *sp, uint32_t id)
+{
+    const ididx_entry_t *e = ididx_get(&sp->ids, id);
+    if (!sp->base || !e)
+        return NULL;
+
+    return sp->base + e->offset;
+}
+
+/* Return requested allocation size */
+size_t slab_allocated_size(const slab_pool_t *sp, uint32_t id)
+{
+    const ididx_entry_t *e = ididx_get(&sp->ids, id);
+    return e ? e->requested_size : 0;
+}
+
+/* Reverse lookup: payload address -> allocation ID */
+uint32_t slab_address_to_id(const slab_pool_t *sp, const void *ptr)
+{
+    const uint8_t *p = ptr;
+
+    if (!sp->base || p < sp->base || p >= sp->base + sp->count * SLAB_SIZE)
+        return 0;
+
+    return ididx_id_at(&sp->ids, (size_t)(p - sp->base));
+}
+
+/* Observability */
+size_t slab_get_count(const slab_pool_t *sp) { return sp->count; }
+
+int slab_get_class_stats(const slab_pool_t *sp, int cls,
+                         slab_class_stats_t *out)
+{
+    if (cls < 0 || cls >= SLAB_NUM_CLASSES)
+        return -1;
+    *out = sp->class_stats[cls];
+    return 0;
+}
+
+int slab_get_info(const slab_pool_t *sp, size_t idx,
+                  int *cls, size_t *used, size_t *slots)
+{
+    if (!sp->slabs || idx >= sp->count)
+        return -1;
+
+    *cls = sp->slabs[idx].cls;
+    *used = sp->slabs[idx].used;
+    *slots = (*cls < 0) ? 0 : class_slots(*cls);
+    return 0;
+}
+
+/* Read-only accessors */
+uint8_t *slab_get_base(const slab_pool_t *sp) { return sp->base; }
@@ -0,0 +1,64 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "id_index.h"
+
+/*
+ * Slab / size-class allocator.
+ *
+ * The heap is carved into SLAB_SIZE slabs. A slab is bound to one size
+ * class on first use and hands out fixed-size slots tracked by a 64-bit
+ * free bitmap; it returns to the empty pool when its last slot is freed.
+ * Requests larger than the biggest class fail.
+ */
+#define SLAB_SIZE         1024
+#define SLAB_NUM_CLASSES  6      /* 16, 32, 64, 128, 256, 512 bytes */
+
+typedef struct {
+    size_t obj_size;          /* slot size of the class */
+    size_t slabs;             /* slabs bound to the class */
+    size_t live_objs;         /* allocated slots */
+    size_t total_slots;       /* slots across its slabs */
+    size_t requested_bytes;   /* bytes requested by live objects */
+} slab_class_stats_t;
+
+/* One pool per heap; every call takes the pool it works on */
+typedef struct slab_pool {
+    uint8_t            *base;
+    size_t              count;
+    struct slab_meta   *slabs;         /* per-slab metadata (out-of-band) */
+    uint32_t            empty_head;
+    uint32_t            partial_head[SLAB_NUM_CLASSES];
+    slab_class_stats_t  class_stats[SLAB_NUM_CLASSES];
+    uint32_t            next_id;
+    id_index_t          ids;
+} slab_pool_t;
+
+/* lifecycle */
+int  slab_init_pool(slab_pool_t *sp, uint8_t *base, size_t bytes);
+void slab_shutdown_pool(slab_pool_t *sp);
+
+/* allocation */
+uint32_t slab_alloc(slab_pool_t *sp, size_t bytes);
+int      slab_free(slab_pool_t *sp, uint32_t id);
+
+/* helpers for CLI & stats */
+void    *slab_allocated_address(const slab_pool_t *sp, uint32_t id);
+size_t   slab_allocated_size(const slab_pool_t *sp, uint32_t id);
+uint32_t slab_address_to_id(const slab_pool_t *sp, const void *ptr);
+
+/* observability */
+size_t slab_get_count(const slab_pool_t *sp);
+int    slab_get_class_stats(const slab_pool_t *sp, int cls,
+                            slab_class_stats_t *out);
+/* class of slab idx (-1 if empty) and its used / total slots */
+int    slab_get_info(const slab_pool_t *sp, size_t idx,
+                     int *cls, size_t *used, size_t *slots);
+
+/* read-only accessors */
+uint8_t *slab_get_base(const slab_pool_t *sp);
+
+#endif /* SLAB_H */
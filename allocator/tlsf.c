@@ -0,0 +1,146 @@
+#include "tlsf.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NIL 0u
+
+/* ================= SIZE MAPPING ================= */
+
+static int floor_log2(size_t v)
+{
+    return 63 - __builtin_clzll((unsigned long long)v);
+}
+
+/* (fl, sl) of the list a block of 'size' belongs to */
+static void mapping_insert(size_t size, int *fl, int *sl)
+{
+    if (size < TLSF_SL_COUNT) {
+        *fl = 0;
+        *sl = (int)size;
+        return;
+    }
+
+    int l = floor_log2(size);
+    *fl = l - TLSF_SL_LOG2 + 1;
+    *sl = (int)((size >> (l - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT);
+}
+
+/* (fl, sl) of the first list whose blocks all fit 'size' */
+static int mapping_search(size_t size, int *fl, int *sl)
+{
+    if (size >= TLSF_SL_COUNT) {
+        size_t round = ((size_t)1 << (floor_log2(size) - TLSF_SL_LOG2)) - 1;
+        if (size + round < size)
+            return -1;
+        size += round;
+    }
+    mapping_insert(size, fl, sl);
+    return 0;
+}
+
+/* ================= LIFECYCLE ================= */
+
+void tlsf_reset(tlsf_index_t *t)
+{
+    t->fl_bitmap = 0;
+    memset(t->sl_bitmap, 0, sizeof(t->sl_bitmap));
+    memset(t->heads, 0, sizeof(t->heads));
+}
+
+void tlsf_destroy(tlsf_index_t *t)
+{
+    free(t->next);
+    free(t->prev);
+    memset(t, 0, sizeof(*t));
+}
+
+static int ensure_cap(tlsf_index_t *t, uint32_t h)
+{
+    if (h < t->cap)
+        return 0;
+
+    uint32_t cap = t->cap ? t->cap : 64;
+    while (cap <= h)
+        cap *= 2;
+
+    uint32_t *n = realloc(t->next, cap * sizeof(uint32_t));
+    if (!n)
+        return -1;
+    t->next = n;
+
+    uint32_t *p = realloc(t->prev, cap * sizeof(uint32_t));
+    if (!p)
+        return -1;
+    t->prev = p;
+
+    t->cap = cap;
+    return 0;
+}
+
+/* ================= MAINTENANCE ================= */
+
+int tlsf_insert(tlsf_index_t *t, size_t size, uint32_t h)
+{
+    int fl, sl;
+
+    if (ensure_cap(t, h) < 0)
+        return -1;
+
+    mapping_insert(size, &fl, &sl);
+
+    uint32_t head = t->heads[fl][sl];
+    t->prev[h] = NIL;
+    t->next[h] = head;
+    if (head)
+        t->prev[head] = h;
+    t->heads[fl][sl] = h;
+
+    t->fl_bitmap |= 1ULL << fl;
+    t->sl_bitmap[fl] |= 1u << sl;
+    return 0;
+}
+
+void tlsf_remove(tlsf_index_t *t, size_t size, uint32_t h)
+{
+    int fl, sl;
+
+    mapping_insert(size, &fl, &sl);
+
+    if (t->prev[h])
+        t->next[t->prev[h]] = t->next[h];
+    else
+        t->heads[fl][sl] = t->next[h];
+    if (t->next[h])
+        t->prev[t->next[h]] = t->prev[h];
+
+    if (!t->heads[fl][sl]) {
+        t->sl_bitmap[fl] &= ~(1u << sl);
+        if (!t->sl_bitmap[fl])
+            t->fl_bitmap &= ~(1ULL << fl);
+    }
+}
+
+/* ================= LOOKUP ================= */
+
+int tlsf_find(const tlsf_index_t *t, size_t req, uint32_t *h)
+{
+    int fl, sl;
+
+    if (mapping_search(req, &fl, &sl) < 0 || fl >= TLSF_FL_COUNT)
+        return -1;
+
+    uint32_t sl_map = t->sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint64_t fl_map = (fl + 1 < 64) ? t->fl_bitmap & (~0ULL << (fl + 1)) : 0;
+        if (!fl_map)
+            return -1;
+
+        fl = __builtin_ctzll(fl_map);
+        sl_map = t->sl_bitmap[fl];
+    }
+
+    sl = __builtin_ctz(sl_map);
+    *h = t->heads[fl][sl];
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * TLSF (two-level segregated fit) free-block index.
+ *
+ * Free blocks from the out-of-band block store are filed into
+ * segregated lists by size: the first level splits by power of two,
+ * the second level splits each power-of-two range into TLSF_SL_COUNT
+ * equal slices. A first-level bitmap and one second-level bitmap per
+ * first level record which lists are non-empty, so a lookup is two
+ * find-first-set operations and insert/remove are O(1) list updates.
+ *
+ * Lookups round the request up to the next slice ("good fit"), so any
+ * block on the chosen list fits without scanning. The price is that a
+ * request can fail while a block of exactly the right size sits in the
+ * slice below the rounded one.
+ */
+
+#define TLSF_SL_LOG2   4
+#define TLSF_SL_COUNT  (1 << TLSF_SL_LOG2)
+#define TLSF_FL_COUNT  (64 - TLSF_SL_LOG2 + 1)
+
+typedef struct {
+    uint64_t  fl_bitmap;
+    uint32_t  sl_bitmap[TLSF_FL_COUNT];
+    uint32_t  heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+    /* free-list links, indexed by block-store handle */
+    uint32_t *next;
+    uint32_t *prev;
+    uint32_t  cap;
+} tlsf_index_t;
+
+/* lifecycle */
+void tlsf_reset(tlsf_index_t *t);
+void tlsf_destroy(tlsf_index_t *t);
+
+/* maintenance (called on split / coalesce) */
+int  tlsf_insert(tlsf_index_t *t, size_t size, uint32_t h);
+void tlsf_remove(tlsf_index_t *t, size_t size, uint32_t h);
+
+/* O(1) lookup: returns 0 and sets *h, or -1 if no list can serve req */
+int tlsf_find(const tlsf_index_t *t, size_t req, uint32_t *h);
+
+#endif /* TLSF_H */
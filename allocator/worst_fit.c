@@ -3,21 +3,15 @@
 
 /*
  * Worst-fit on out-of-band metadata
- * Returns index of largest suitable block, or -1
+ * Answered by the free-space index in O(log n)
+ * Returns block-store handle of largest suitable block, or -1
  */
 
-int wf_find(size_t req) {
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
+int wf_find(mem_heap_t *heap, size_t req) {
+    uint32_t h;
 
-    int worst = -1;
+    if (fidx_worst_fit(allocator_get_free_index(heap), req, &h) < 0)
+        return -1;
 
-    for (size_t i = 0; i < count; i++) {
-        if (blocks[i].free && blocks[i].size >= req) {
-            if (worst == -1 || blocks[i].size > blocks[worst].size) {
-                worst = (int)i;
-            }
-        }
-    }
-    return worst;
+    return (int)h;
 }
@@ -3,10 +3,12 @@
 
 #include <stddef.h>
 
+#include "allocator.h"
+
 /*
  * Worst-fit allocator (out-of-band metadata)
- * Returns index of largest suitable free block, or -1
+ * Returns block-store handle of largest suitable free block, or -1
  */
-int wf_find(size_t req);
+int wf_find(mem_heap_t *heap, size_t req);
 
 #endif /* WORST_FIT_H */
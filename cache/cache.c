@@ -1,240 +1,1169 @@
 #include "cache.h"
+#include "cache_simd.h"
+#include "prefetch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 /* =========================
    INTERNAL STRUCTURES
    ========================= */
 
-typedef struct {
-    uint64_t tag;
-    int valid;
-    int dirty;
-    uint64_t insertion_time;
-    uint64_t lru_time;
-} cache_line_t;
-
-typedef struct {
-    cache_line_t *lines;
-} cache_set_t;
+/*
+ * Tag store, struct-of-arrays: each set is one row of 'associativity'
+ * ways in every array, so a lookup reads one contiguous run of tags plus
+ * a valid and a dirty word. Ways are limited to 64 so the per-set masks
+ * fit one word.
+ *
+ * age[] holds one byte of replacement state per way:
+ *   LRU / FIFO   rank among the valid ways, 0 = newest. LRU re-ranks on
+ *                every hit, FIFO only on fills; the victim of a full set
+ *                is the way ranked associativity - 1. Invalid ways hold
+ *                AGE_INVALID, which ranks above every valid way, so
+ *                re-ranking needs no valid-mask test.
+ *   SRRIP/BRRIP  2-bit re-reference prediction value, RRPV_MAX = distant
+ *   LFU          saturating use counter
+ * PLRU keeps its assoc-1 tree bits in one plru[] word per set instead.
+ * Random and BRRIP draw from a per-level xorshift generator with a fixed
+ * seed, so runs are reproducible.
+ *
+ * Tag match, victim search and re-ranking go through the SIMD kernels
+ * picked at cache_create (see cache_simd.h); the arrays carry the tail
+ * padding those kernels read past the last set.
+ *
+ * The level a prefetcher fills also tracks, per way, whether the line was
+ * prefetched and not yet used and when its data arrives, plus a small
+ * direct-mapped filter of lines that prefetches evicted (to spot demand
+ * misses they caused).
+ */
+#define AGE_INVALID 0x7F
+#define RRPV_MAX    3
+#define BRRIP_NEAR  32            /* 1 in 32 BRRIP fills predicted long */
+#define PF_VICTIMS  1024          /* pollution filter slots, power of two */
 
 typedef struct {
-    char name[4];                 /* L1 / L2 / L3 */
+    char name[8];                 /* L1 / L2 / L3 ... */
     size_t size;                  /* total bytes */
     size_t block_size;            /* bytes per block */
     int associativity;
     int num_sets;
-    int policy;                   /* CACHE_LRU / CACHE_FIFO */
+    int policy;                   /* CACHE_LRU, CACHE_FIFO, ... */
+    uint32_t latency;
+    int write_back;               /* CACHE_WRITE_BACK */
+    int write_alloc;              /* CACHE_WRITE_ALLOCATE */
 
-    cache_set_t *sets;
+    /* indexing: shift/mask when num_sets is a power of two */
+    unsigned line_shift;
+    unsigned set_shift;
+    uint64_t set_mask;
+    int sets_pow2;
+
+    uint64_t *tags;               /* [num_sets * associativity] */
+    uint8_t  *age;                /* [num_sets * associativity] */
+    uint64_t *valid;              /* [num_sets], bit w = way w */
+    uint64_t *dirty;              /* [num_sets] */
+    uint64_t *plru;               /* [num_sets] tree bits, PLRU only */
+    uint64_t all_ways;            /* mask of the ways that exist */
+
+    const cache_simd_t *simd;
+    uint64_t rng;                 /* RANDOM / BRRIP */
+
+    /* prefetch target level only (NULL elsewhere) */
+    uint64_t *pf_bits;            /* [num_sets], bit w = way w prefetched, unused */
+    uint64_t *pf_ready;           /* [num_sets * associativity] cycle the data lands */
+    uint64_t *pf_victims;         /* [PF_VICTIMS] line number + 1 */
+    int       pf_filling;         /* the fill in progress is a prefetch */
+    uint64_t  pf_fill_ready;
+    uint64_t  pf_unused;          /* prefetched lines dropped before any use */
 
     uint64_t hits;
     uint64_t misses;
-    uint64_t global_time;
+    uint64_t writebacks;          /* dirty lines evicted */
 } cache_level_t;
 
-typedef struct {
-    cache_level_t l1;
-    cache_level_t l2;
-    cache_level_t l3;
+struct cache_controller {
+    cache_config_t cfg;
+    int num_levels;
+    cache_level_t levels[CACHE_MAX_LEVELS];
 
     uint64_t total_requests;
     uint64_t total_cycles;
-} cache_controller_t;
+    uint64_t ram_read_bytes;      /* line fetches */
+    uint64_t ram_write_bytes;     /* write-backs and write-through words */
+
+    prefetcher_t pf;
+    uint64_t pf_issued;
+    uint64_t pf_useful;           /* first use after the data arrived */
+    uint64_t pf_late;             /* first use while still in flight */
+    uint64_t pf_polluting;        /* demand misses on lines a prefetch evicted */
+
+    int verbose;                  /* per-access trace on stdout */
+};
 
 /* =========================
-   GLOBAL CONTROLLER
+   CONFIGURATION
    ========================= */
 
-static cache_controller_t cache;
+static const char *const policy_names[] = {
+    [CACHE_LRU]    = "lru",
+    [CACHE_FIFO]   = "fifo",
+    [CACHE_PLRU]   = "plru",
+    [CACHE_SRRIP]  = "srrip",
+    [CACHE_BRRIP]  = "brrip",
+    [CACHE_LFU]    = "lfu",
+    [CACHE_RANDOM] = "random",
+};
+
+static const char *const write_names[] = {
+    [CACHE_WRITE_BACK]    = "back",
+    [CACHE_WRITE_THROUGH] = "through",
+};
+
+static const char *const write_alloc_names[] = {
+    [CACHE_WRITE_ALLOCATE]    = "on",
+    [CACHE_NO_WRITE_ALLOCATE] = "off",
+};
+
+static const char *const prefetch_names[] = {
+    [CACHE_PF_NONE]      = "none",
+    [CACHE_PF_NEXT_LINE] = "next-line",
+    [CACHE_PF_STRIDE]    = "stride",
+    [CACHE_PF_STREAM]    = "stream",
+};
+
+static const char *const inclusion_names[] = {
+    [CACHE_NINE]      = "nine",
+    [CACHE_INCLUSIVE] = "inclusive",
+    [CACHE_EXCLUSIVE] = "exclusive",
+};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static int name_lookup(const char *const *names, int n, const char *s) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(names[i], s) == 0)
+            return i;
+    }
+    return -1;
+}
+
+void cache_default_config(cache_config_t *cfg) {
+    static const cache_level_config_t defaults[3] = {
+        { "L1", 1024,  64, 2, CACHE_LRU,  L1_LATENCY, CACHE_WRITE_BACK, CACHE_WRITE_ALLOCATE },
+        { "L2", 4096,  64, 4, CACHE_LRU,  L2_LATENCY, CACHE_WRITE_BACK, CACHE_WRITE_ALLOCATE },
+        { "L3", 16384, 64, 8, CACHE_FIFO, L3_LATENCY, CACHE_WRITE_BACK, CACHE_WRITE_ALLOCATE },
+    };
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_levels = 3;
+    memcpy(cfg->levels, defaults, sizeof(defaults));
+    cfg->ram_latency = RAM_LATENCY;
+    cfg->inclusion = CACHE_NINE;
+    cfg->prefetch = (cache_prefetch_config_t){ CACHE_PF_NONE, 0, 1, 1 };
+}
+
+static int is_pow2(size_t v) {
+    return v && !(v & (v - 1));
+}
+
+int cache_validate_config(const cache_config_t *cfg) {
+    if (cfg->num_levels < 1 || cfg->num_levels > CACHE_MAX_LEVELS)
+        return -1;
+
+    for (int i = 0; i < cfg->num_levels; i++) {
+        const cache_level_config_t *lc = &cfg->levels[i];
+
+        if (!is_pow2(lc->line_size) || lc->assoc < 1 ||
+            lc->size < lc->line_size * (size_t)lc->assoc ||
+            lc->size % (lc->line_size * (size_t)lc->assoc) != 0 ||
+            lc->assoc > 64 ||
+            lc->policy < 0 || lc->policy >= COUNT_OF(policy_names) ||
+            lc->write_policy < 0 || lc->write_policy >= COUNT_OF(write_names) ||
+            lc->write_miss < 0 || lc->write_miss >= COUNT_OF(write_alloc_names))
+            return -1;
+
+        /* the tree needs a leaf per way */
+        if (lc->policy == CACHE_PLRU && !is_pow2((size_t)lc->assoc))
+            return -1;
+
+        /* victims move between levels whole */
+        if (cfg->inclusion == CACHE_EXCLUSIVE &&
+            lc->line_size != cfg->levels[0].line_size)
+            return -1;
+    }
+
+    const cache_prefetch_config_t *pf = &cfg->prefetch;
+    if (pf->type < 0 || pf->type >= COUNT_OF(prefetch_names))
+        return -1;
+    if (pf->type != CACHE_PF_NONE &&
+        (pf->level < 0 || pf->level >= cfg->num_levels ||
+         pf->degree < 1 || pf->degree > CACHE_PF_MAX_DEGREE ||
+         pf->distance < 1 || pf->distance > 64))
+        return -1;
+    return 0;
+}
+
+/* Byte count with optional K / M / G suffix */
+static int parse_size(const char *s, size_t *out) {
+    char *end;
+    unsigned long long v = strtoull(s, &end, 10);
+
+    if (end == s)
+        return -1;
+
+    switch (toupper((unsigned char)*end)) {
+    case 'K': v <<= 10; end++; break;
+    case 'M': v <<= 20; end++; break;
+    case 'G': v <<= 30; end++; break;
+    }
+    if (*end != '\0')
+        return -1;
+
+    *out = (size_t)v;
+    return 0;
+}
+
+/* One "key=value" field of a level line */
+static int parse_level_field(cache_level_config_t *lc, char *field) {
+    char *eq = strchr(field, '=');
+    size_t v;
+
+    if (!eq)
+        return -1;
+    *eq = '\0';
+    const char *key = field, *val = eq + 1;
+
+    if (strcmp(key, "policy") == 0) {
+        lc->policy = name_lookup(policy_names, COUNT_OF(policy_names), val);
+        return lc->policy < 0 ? -1 : 0;
+    }
+    if (strcmp(key, "write") == 0) {
+        lc->write_policy = name_lookup(write_names, COUNT_OF(write_names), val);
+        return lc->write_policy < 0 ? -1 : 0;
+    }
+    if (strcmp(key, "write_alloc") == 0) {
+        lc->write_miss = name_lookup(write_alloc_names, COUNT_OF(write_alloc_names), val);
+        return lc->write_miss < 0 ? -1 : 0;
+    }
+
+    if (parse_size(val, &v) != 0)
+        return -1;
+
+    if (strcmp(key, "size") == 0)
+        lc->size = v;
+    else if (strcmp(key, "line") == 0)
+        lc->line_size = v;
+    else if (strcmp(key, "assoc") == 0)
+        lc->assoc = (int)v;
+    else if (strcmp(key, "latency") == 0)
+        lc->latency = (uint32_t)v;
+    else
+        return -1;
+    return 0;
+}
+
+/* prefetch <type> [level=<name>] [degree=<n>] [distance=<n>] */
+static int parse_prefetch(cache_config_t *cfg, const char *type) {
+    cache_prefetch_config_t *pf = &cfg->prefetch;
+    char *f;
+
+    pf->type = name_lookup(prefetch_names, COUNT_OF(prefetch_names), type);
+    if (pf->type < 0)
+        return -1;
+
+    while ((f = strtok(NULL, " \t\r\n"))) {
+        char *eq = strchr(f, '=');
+        size_t v;
+
+        if (!eq)
+            return -1;
+        *eq = '\0';
+
+        if (strcmp(f, "level") == 0) {
+            pf->level = -1;
+            for (int i = 0; i < cfg->num_levels; i++) {
+                if (strcmp(cfg->levels[i].name, eq + 1) == 0)
+                    pf->level = i;
+            }
+            if (pf->level < 0)
+                return -1;
+        } else if (parse_size(eq + 1, &v) != 0) {
+            return -1;
+        } else if (strcmp(f, "degree") == 0) {
+            pf->degree = (int)v;
+        } else if (strcmp(f, "distance") == 0) {
+            pf->distance = (int)v;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Config file, one directive per line, '#' starts a comment:
+ *
+ *   inclusion   nine | inclusive | exclusive
+ *   ram_latency <cycles>
+ *   level <name> size=<bytes> line=<bytes> assoc=<ways>
+ *                policy=<lru|fifo|plru|srrip|brrip|lfu|random>
+ *                latency=<cycles> write=<back|through>
+ *                write_alloc=<on|off>
+ *   prefetch    none | next-line | stride | stream
+ *               [level=<name>] [degree=<lines>] [distance=<lines>]
+ *
+ * Levels are listed closest to the CPU first. Sizes accept K/M/G.
+ * Unset level fields default to 64-byte lines, LRU, 1 cycle, write-back
+ * and write-allocate. prefetch names an earlier level (default the
+ * first) and defaults to degree 1, distance 1.
+ */
+int cache_load_config(const char *path, cache_config_t *out) {
+    FILE *fp = fopen(path, "r");
+    cache_config_t cfg;
+    char line[256];
+    int lineno = 0;
+    int bad = 0;
+
+    if (!fp) {
+        fprintf(stderr, "%s: cannot open cache config\n", path);
+        return -1;
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.ram_latency = RAM_LATENCY;
+    cfg.inclusion = CACHE_NINE;
+    cfg.prefetch = (cache_prefetch_config_t){ CACHE_PF_NONE, 0, 1, 1 };
+
+    while (!bad && fgets(line, sizeof(line), fp)) {
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+
+        lineno++;
+        char *key = strtok(line, " \t\r\n");
+        if (!key)
+            continue;
+
+        char *val = strtok(NULL, " \t\r\n");
+        size_t v;
+
+        if (strcmp(key, "inclusion") == 0 && val) {
+            cfg.inclusion = name_lookup(inclusion_names, COUNT_OF(inclusion_names), val);
+            bad = cfg.inclusion < 0;
+        } else if (strcmp(key, "prefetch") == 0 && val) {
+            bad = parse_prefetch(&cfg, val) != 0;
+        } else if (strcmp(key, "ram_latency") == 0 && val && parse_size(val, &v) == 0) {
+            cfg.ram_latency = (uint32_t)v;
+        } else if (strcmp(key, "level") == 0 && val && cfg.num_levels < CACHE_MAX_LEVELS) {
+            cache_level_config_t *lc = &cfg.levels[cfg.num_levels++];
+
+            *lc = (cache_level_config_t){ .line_size = 64, .assoc = 1,
+                                          .policy = CACHE_LRU, .latency = 1,
+                                          .write_policy = CACHE_WRITE_BACK,
+                                          .write_miss = CACHE_WRITE_ALLOCATE };
+            snprintf(lc->name, sizeof(lc->name), "%s", val);
+
+            for (char *f; !bad && (f = strtok(NULL, " \t\r\n"));)
+                bad = parse_level_field(lc, f) != 0;
+        } else {
+            bad = 1;
+        }
+    }
+    fclose(fp);
+
+    if (bad) {
+        fprintf(stderr, "%s:%d: bad cache config line\n", path, lineno);
+        return -1;
+    }
+    if (cache_validate_config(&cfg) != 0) {
+        fprintf(stderr, "%s: invalid cache geometry\n", path);
+        return -1;
+    }
+
+    *out = cfg;
+    return 0;
+}
+
+void cache_print_config(const cache_config_t *cfg) {
+    printf("Inclusion   : %s\n", inclusion_names[cfg->inclusion]);
+    for (int i = 0; i < cfg->num_levels; i++) {
+        const cache_level_config_t *lc = &cfg->levels[i];
+        printf("[%s] %zu bytes, %zu-byte lines, %d-way, %s, write-%s, %s, %u cycles\n",
+               lc->name, lc->size, lc->line_size, lc->assoc,
+               policy_names[lc->policy], write_names[lc->write_policy],
+               lc->write_miss == CACHE_WRITE_ALLOCATE ? "write-allocate"
+                                                      : "no-write-allocate",
+               lc->latency);
+    }
+    printf("RAM latency : %u cycles\n", cfg->ram_latency);
+
+    const cache_prefetch_config_t *pf = &cfg->prefetch;
+    if (pf->type == CACHE_PF_NONE)
+        printf("Prefetch    : none\n");
+    else
+        printf("Prefetch    : %s into %s, degree %d, distance %d\n",
+               prefetch_names[pf->type], cfg->levels[pf->level].name,
+               pf->degree, pf->distance);
+}
 
 /* =========================
    HELPERS
    ========================= */
 
-static void cache_level_init(
-    cache_level_t *lvl,
-    const char *name,
-    size_t size,
-    size_t block_size,
-    int assoc,
-    int policy
-) {
-    strncpy(lvl->name, name, sizeof(lvl->name));
-    lvl->size = size;
-    lvl->block_size = block_size;
-    lvl->associativity = assoc;
-    lvl->policy = policy;
+static unsigned log2_of(uint64_t v) {
+    return (unsigned)__builtin_ctzll(v);
+}
+
+static int cache_level_init(cache_level_t *lvl, const cache_level_config_t *lc,
+                            const cache_simd_t *simd) {
+    snprintf(lvl->name, sizeof(lvl->name), "%s", lc->name);
+    lvl->size = lc->size;
+    lvl->block_size = lc->line_size;
+    lvl->associativity = lc->assoc;
+    lvl->policy = lc->policy;
+    lvl->latency = lc->latency;
+    lvl->write_back = (lc->write_policy == CACHE_WRITE_BACK);
+    lvl->write_alloc = (lc->write_miss == CACHE_WRITE_ALLOCATE);
+    lvl->simd = simd;
+    lvl->rng = 0x9E3779B97F4A7C15ULL;
+    lvl->all_ways = (lc->assoc == 64) ? ~0ULL : (1ULL << lc->assoc) - 1;
 
-    lvl->num_sets = (int)(size / (block_size * assoc));
-    lvl->sets = (cache_set_t *)malloc(sizeof(cache_set_t) * lvl->num_sets);
+    lvl->num_sets = (int)(lc->size / (lc->line_size * lc->assoc));
+    lvl->line_shift = log2_of(lc->line_size);
+    lvl->sets_pow2 = is_pow2((size_t)lvl->num_sets);
+    if (lvl->sets_pow2) {
+        lvl->set_shift = log2_of((uint64_t)lvl->num_sets);
+        lvl->set_mask = (uint64_t)lvl->num_sets - 1;
+    }
+
+    size_t ways = (size_t)lvl->num_sets * lc->assoc;
+    lvl->tags  = calloc(ways + CACHE_SIMD_PAD_TAGS, sizeof(uint64_t));
+    lvl->age   = malloc(ways + CACHE_SIMD_PAD_AGES);
+    lvl->valid = calloc(lvl->num_sets, sizeof(uint64_t));
+    lvl->dirty = calloc(lvl->num_sets, sizeof(uint64_t));
+    if (!lvl->tags || !lvl->age || !lvl->valid || !lvl->dirty)
+        return -1;
+    memset(lvl->age, AGE_INVALID, ways + CACHE_SIMD_PAD_AGES);
 
-    for (int i = 0; i < lvl->num_sets; i++) {
-        lvl->sets[i].lines =
-            (cache_line_t *)calloc(assoc, sizeof(cache_line_t));
+    if (lvl->policy == CACHE_PLRU) {
+        lvl->plru = calloc(lvl->num_sets, sizeof(uint64_t));
+        if (!lvl->plru)
+            return -1;
     }
 
     lvl->hits = 0;
     lvl->misses = 0;
-    lvl->global_time = 0;
+    lvl->writebacks = 0;
+    return 0;
 }
 
 static void cache_level_free(cache_level_t *lvl) {
-    for (int i = 0; i < lvl->num_sets; i++) {
-        free(lvl->sets[i].lines);
+    free(lvl->tags);
+    free(lvl->age);
+    free(lvl->valid);
+    free(lvl->dirty);
+    free(lvl->plru);
+    free(lvl->pf_bits);
+    free(lvl->pf_ready);
+    free(lvl->pf_victims);
+    lvl->tags = NULL;
+    lvl->plru = NULL;
+    lvl->pf_bits = lvl->pf_ready = lvl->pf_victims = NULL;
+    lvl->age = NULL;
+    lvl->valid = lvl->dirty = NULL;
+}
+
+static void cache_level_index(const cache_level_t *lvl, uint64_t address,
+                              uint64_t *set, uint64_t *tag) {
+    uint64_t block_addr = address >> lvl->line_shift;
+
+    if (lvl->sets_pow2) {
+        *set = block_addr & lvl->set_mask;
+        *tag = block_addr >> lvl->set_shift;
+    } else {
+        *set = block_addr % (uint64_t)lvl->num_sets;
+        *tag = block_addr / (uint64_t)lvl->num_sets;
     }
-    free(lvl->sets);
 }
 
-static int cache_level_access(cache_level_t *lvl, uint64_t address, int is_write) {
-    lvl->global_time++;
+/* Way holding 'tag' in 'set', or -1 */
+static int cache_level_find(const cache_level_t *lvl, uint64_t set, uint64_t tag) {
+    const uint64_t *tags = &lvl->tags[set * lvl->associativity];
+    uint64_t m = lvl->simd->tag_match(tags, lvl->associativity, tag) & lvl->valid[set];
 
-    uint64_t block_addr = address / lvl->block_size;
-    uint64_t set_index = block_addr % lvl->num_sets;
-    uint64_t tag = block_addr / lvl->num_sets;
+    return m ? __builtin_ctzll(m) : -1;
+}
 
-    cache_set_t *set = &lvl->sets[set_index];
+/* =========================
+   REPLACEMENT POLICIES
+   ========================= */
+
+static uint64_t level_rand(cache_level_t *lvl) {
+    uint64_t x = lvl->rng;
 
-    /* HIT CHECK */
-    for (int i = 0; i < lvl->associativity; i++) {
-        cache_line_t *line = &set->lines[i];
-        if (line->valid && line->tag == tag) {
-            lvl->hits++;
-            if (lvl->policy == CACHE_LRU)
-                line->lru_time = lvl->global_time;
-            if (is_write)
-                line->dirty = 1;
-            return 1; /* HIT */
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return lvl->rng = x;
+}
+
+/* Make 'way' the newest: valid ways ranked below 'from' age by one */
+static void rank_touch(cache_level_t *lvl, uint8_t *age, int way, int from) {
+    lvl->simd->age_bump(age, lvl->associativity, (uint8_t)from);
+    age[way] = 0;
+}
+
+/*
+ * Tree-PLRU: node n (1-based, children 2n and 2n+1) points to the half
+ * holding the next victim, 0 = left. An access points every node on the
+ * way's path away from it.
+ */
+static void plru_touch(cache_level_t *lvl, uint64_t set, int way) {
+    int depth = (int)log2_of((uint64_t)lvl->associativity);
+    uint64_t bits = lvl->plru[set];
+    unsigned node = 1;
+
+    for (int d = depth - 1; d >= 0; d--) {
+        unsigned right = ((unsigned)way >> d) & 1;
+
+        bits = (bits & ~(1ULL << node)) | ((uint64_t)!right << node);
+        node = 2 * node + right;
+    }
+    lvl->plru[set] = bits;
+}
+
+static int plru_victim(const cache_level_t *lvl, uint64_t set) {
+    uint64_t bits = lvl->plru[set];
+    unsigned node = 1;
+
+    while (node < (unsigned)lvl->associativity)
+        node = 2 * node + ((bits >> node) & 1);
+    return (int)(node - (unsigned)lvl->associativity);
+}
+
+static void repl_hit(cache_level_t *lvl, uint64_t set, int way) {
+    uint8_t *age = &lvl->age[set * lvl->associativity];
+
+    switch (lvl->policy) {
+    case CACHE_LRU:
+        rank_touch(lvl, age, way, age[way]);
+        break;
+    case CACHE_PLRU:
+        plru_touch(lvl, set, way);
+        break;
+    case CACHE_SRRIP:
+    case CACHE_BRRIP:
+        age[way] = 0;
+        break;
+    case CACHE_LFU:
+        /* halve the set on saturation so old favourites can fade */
+        if (age[way] == UINT8_MAX) {
+            for (int w = 0; w < lvl->associativity; w++)
+                age[w] >>= 1;
+        }
+        age[way]++;
+        break;
+    default: /* FIFO, RANDOM */
+        break;
+    }
+}
+
+/* 'way' has just been (re)filled */
+static void repl_fill(cache_level_t *lvl, uint64_t set, int way) {
+    uint8_t *age = &lvl->age[set * lvl->associativity];
+
+    switch (lvl->policy) {
+    case CACHE_LRU:
+    case CACHE_FIFO:
+        /* an empty way holds AGE_INVALID, so every valid way ages */
+        rank_touch(lvl, age, way, age[way]);
+        break;
+    case CACHE_PLRU:
+        plru_touch(lvl, set, way);
+        break;
+    case CACHE_SRRIP:
+        age[way] = RRPV_MAX - 1;
+        break;
+    case CACHE_BRRIP:
+        age[way] = (level_rand(lvl) % BRRIP_NEAR == 0) ? RRPV_MAX - 1 : RRPV_MAX;
+        break;
+    case CACHE_LFU:
+        age[way] = 1;
+        break;
+    default: /* RANDOM */
+        break;
+    }
+}
+
+/* Way to evict from a full set */
+static int repl_victim(cache_level_t *lvl, uint64_t set) {
+    int assoc = lvl->associativity;
+    uint8_t *age = &lvl->age[set * assoc];
+    int way = 0;
+
+    switch (lvl->policy) {
+    case CACHE_PLRU:
+        return plru_victim(lvl, set);
+
+    case CACHE_SRRIP:
+    case CACHE_BRRIP: {
+        /* age the set until some way is predicted distant */
+        uint8_t max = 0;
+        for (int w = 0; w < assoc; w++)
+            max = age[w] > max ? age[w] : max;
+        if (max < RRPV_MAX) {
+            for (int w = 0; w < assoc; w++)
+                age[w] += RRPV_MAX - max;
         }
+        return __builtin_ctzll(lvl->simd->age_match(age, assoc, RRPV_MAX) &
+                               lvl->all_ways);
+    }
+
+    case CACHE_LFU:
+        for (int w = 1; w < assoc; w++) {
+            if (age[w] < age[way])
+                way = w;
+        }
+        return way;
+
+    case CACHE_RANDOM:
+        return (int)(level_rand(lvl) % (uint64_t)assoc);
+
+    default: /* LRU, FIFO: oldest-ranked way */
+        return __builtin_ctzll(lvl->simd->age_match(age, assoc, (uint8_t)(assoc - 1)) &
+                               lvl->all_ways);
+    }
+}
+
+static void repl_invalidate(cache_level_t *lvl, uint64_t set, int way) {
+    uint8_t *age = &lvl->age[set * lvl->associativity];
+
+    if (lvl->policy != CACHE_LRU && lvl->policy != CACHE_FIFO)
+        return;
+
+    /* close the gap in the ranking */
+    for (int w = 0; w < lvl->associativity; w++) {
+        if (age[w] > age[way] && age[w] != AGE_INVALID)
+            age[w]--;
+    }
+    age[way] = AGE_INVALID;
+}
+
+/* =========================
+   LEVEL OPERATIONS
+   ========================= */
+
+/* Probe a level: counts the hit or miss; never allocates. 'is_write'
+   dirties the line on a hit (the caller passes it only where the write
+   lands). Returns the hit way and its set in *set, or -1. */
+static int cache_level_lookup(cache_level_t *lvl, uint64_t address, int is_write,
+                              uint64_t *set) {
+    uint64_t tag;
+
+    cache_level_index(lvl, address, set, &tag);
+
+    int way = cache_level_find(lvl, *set, tag);
+    if (way >= 0) {
+        lvl->hits++;
+        repl_hit(lvl, *set, way);
+        if (is_write)
+            lvl->dirty[*set] |= 1ULL << way;
+        return way; /* HIT */
     }
 
-    /* MISS */
     lvl->misses++;
+    return -1;
+}
+
+/* Presence test without touching counters or replacement state */
+static int cache_level_holds(const cache_level_t *lvl, uint64_t address) {
+    uint64_t set, tag;
+
+    cache_level_index(lvl, address, &set, &tag);
+    return cache_level_find(lvl, set, tag) >= 0;
+}
+
+/* Prefetch bookkeeping for a fill of 'way' (prefetch target level only) */
+static void pf_note_fill(cache_level_t *lvl, uint64_t set, int way,
+                         int evicted, uint64_t victim) {
+    uint64_t bit = 1ULL << way;
+
+    if (evicted && (lvl->pf_bits[set] & bit))
+        lvl->pf_unused++;
+
+    if (!lvl->pf_filling) {
+        lvl->pf_bits[set] &= ~bit;
+        return;
+    }
+
+    if (evicted) {
+        uint64_t line = victim >> lvl->line_shift;
+        lvl->pf_victims[line & (PF_VICTIMS - 1)] = line + 1;
+    }
+    lvl->pf_bits[set] |= bit;
+    lvl->pf_ready[set * lvl->associativity + way] = lvl->pf_fill_ready;
+}
+
+/*
+ * Install the line holding 'address', which the caller knows is not in
+ * this level (it just missed, or is a victim under exclusion). Returns 1
+ * and the evicted line's address and dirty bit in *victim / *victim_dirty
+ * if a valid line had to make room, else 0.
+ */
+static int cache_level_fill(cache_level_t *lvl, uint64_t address, int dirty,
+                            uint64_t *victim, int *victim_dirty) {
+    uint64_t set, tag;
+    int assoc = lvl->associativity;
+    int evicted = 0;
+    int way;
+
+    cache_level_index(lvl, address, &set, &tag);
+
+    uint64_t empty = ~lvl->valid[set] & lvl->all_ways;
+    if (empty) {
+        way = __builtin_ctzll(empty);
+    } else {
+        way = repl_victim(lvl, set);
+        *victim = (lvl->tags[set * assoc + way] * lvl->num_sets + set)
+                  << lvl->line_shift;
+        *victim_dirty = (int)((lvl->dirty[set] >> way) & 1);
+        evicted = 1;
+    }
+    repl_fill(lvl, set, way);
+    if (lvl->pf_bits)
+        pf_note_fill(lvl, set, way, evicted, evicted ? *victim : 0);
+
+    lvl->tags[set * assoc + way] = tag;
+    lvl->valid[set] |= 1ULL << way;
+    lvl->dirty[set] = (lvl->dirty[set] & ~(1ULL << way)) |
+                      ((uint64_t)(dirty != 0) << way);
+    return evicted;
+}
+
+/* Drop the line holding 'address'; returns 1 if it was dirty */
+static int cache_level_invalidate(cache_level_t *lvl, uint64_t address) {
+    uint64_t set, tag;
+
+    cache_level_index(lvl, address, &set, &tag);
+
+    int way = cache_level_find(lvl, set, tag);
+    if (way < 0)
+        return 0;
+
+    int dirty = (int)((lvl->dirty[set] >> way) & 1);
+
+    if (lvl->pf_bits && ((lvl->pf_bits[set] >> way) & 1)) {
+        lvl->pf_unused++;
+        lvl->pf_bits[set] &= ~(1ULL << way);
+    }
+    repl_invalidate(lvl, set, way);
+    lvl->valid[set] &= ~(1ULL << way);
+    lvl->dirty[set] &= ~(1ULL << way);
+    return dirty;
+}
+
+/* Mark the line dirty if present; returns 1 if the level holds it */
+static int cache_level_mark_dirty(cache_level_t *lvl, uint64_t address) {
+    uint64_t set, tag;
+
+    cache_level_index(lvl, address, &set, &tag);
+
+    int way = cache_level_find(lvl, set, tag);
+    if (way < 0)
+        return 0;
+
+    if (lvl->write_back)
+        lvl->dirty[set] |= 1ULL << way;
+    return 1;
+}
+
+/* =========================
+   WRITE PROPAGATION
+   ========================= */
+
+/*
+ * Hand 'bytes' of modified data for 'address' to the levels from 'from'
+ * down: the first write-back level holding the line absorbs it, levels
+ * without the line or writing through pass it on, and RAM takes what is
+ * left. Returns the absorbing level, or num_levels for RAM.
+ */
+static int cache_write_down(cache_t *cache, int from, uint64_t address,
+                            uint64_t bytes) {
+    for (int i = from; i < cache->num_levels; i++) {
+        cache_level_t *lvl = &cache->levels[i];
+
+        if (cache_level_mark_dirty(lvl, address) && lvl->write_back)
+            return i;
+    }
+    cache->ram_write_bytes += bytes;
+    return cache->num_levels;
+}
+
+/* A dirty line left level 'from': write it back, charging the receiver */
+static void cache_writeback(cache_t *cache, int from, uint64_t line) {
+    int to;
+
+    cache->levels[from].writebacks++;
+    to = cache_write_down(cache, from + 1, line, cache->levels[from].block_size);
+    cache->total_cycles += (to < cache->num_levels) ? cache->levels[to].latency
+                                                    : cache->cfg.ram_latency;
+}
+
+/* =========================
+   INCLUSION POLICIES
+   ========================= */
+
+/*
+ * Inclusive: a line leaving level 'from' leaves every level above it.
+ * Returns 1 if any of those copies was dirty.
+ */
+static int back_invalidate(cache_t *cache, int from, uint64_t victim) {
+    size_t span = cache->levels[from].block_size;
+    int dirty = 0;
+
+    for (int i = 0; i < from; i++) {
+        cache_level_t *lvl = &cache->levels[i];
+        uint64_t a = victim - victim % lvl->block_size;
+
+        for (; a < victim + span; a += lvl->block_size)
+            dirty |= cache_level_invalidate(lvl, a);
+    }
+    return dirty;
+}
+
+/*
+ * Bring the line into levels 'top' .. 'hit' - 1 (hit -1: missed
+ * everywhere); demand accesses fill from the top level, prefetches from
+ * their target. Demand fills are clean; the caller applies a write
+ * afterwards. A write miss skips no-write-allocate levels (and, when
+ * inclusive, everything above them). Returns the lowest level that took
+ * the line, or -1.
+ */
+static int cache_fill_levels(cache_t *cache, uint64_t address, int is_write,
+                             int top, int hit) {
+    int missed = (hit < 0) ? cache->num_levels : hit;
+    int lowest = -1;
+    uint64_t victim;
+    int vdirty;
 
-    /* EMPTY SLOT */
-    for (int i = 0; i < lvl->associativity; i++) {
-        cache_line_t *line = &set->lines[i];
-        if (!line->valid) {
-            line->valid = 1;
-            line->tag = tag;
-            line->dirty = is_write;
-            line->insertion_time = lvl->global_time;
-            line->lru_time = lvl->global_time;
-            return 0;
+    switch (cache->cfg.inclusion) {
+    case CACHE_INCLUSIVE:
+        for (int i = missed - 1; i >= top; i--) {
+            if (is_write && !cache->levels[i].write_alloc)
+                break;
+            if (lowest < 0)
+                lowest = i;
+            if (cache_level_fill(&cache->levels[i], address, 0, &victim, &vdirty)) {
+                vdirty |= back_invalidate(cache, i, victim);
+                if (vdirty)
+                    cache_writeback(cache, i, victim);
+            }
         }
+        break;
+
+    case CACHE_EXCLUSIVE: {
+        if (hit == top || (is_write && !cache->levels[top].write_alloc))
+            break;
+
+        /* the line moves up with its dirty data */
+        int dirty = (hit > top) ? cache_level_invalidate(&cache->levels[hit], address) : 0;
+
+        lowest = top;
+
+        /* new line goes to the top level, each victim one level down */
+        for (int i = top; i < cache->num_levels; i++) {
+            cache_level_t *lvl = &cache->levels[i];
+
+            if (dirty && !lvl->write_back) {
+                cache_write_down(cache, i + 1, address, lvl->block_size);
+                dirty = 0;
+            }
+            if (!cache_level_fill(lvl, address, dirty, &victim, &vdirty))
+                break;
+            address = victim;
+            dirty = vdirty;
+            if (i == cache->num_levels - 1 && dirty)
+                cache_writeback(cache, i, victim);
+        }
+        break;
+    }
+
+    default: /* CACHE_NINE */
+        for (int i = top; i < missed; i++) {
+            if (is_write && !cache->levels[i].write_alloc)
+                continue;
+            lowest = i;
+            if (cache_level_fill(&cache->levels[i], address, 0, &victim, &vdirty) && vdirty)
+                cache_writeback(cache, i, victim);
+        }
+        break;
     }
+    return lowest;
+}
+
+/* =========================
+   PREFETCH
+   ========================= */
+
+/* Fetch one line into the prefetch level unless some level up to it has it */
+static void cache_prefetch_line(cache_t *cache, uint64_t line) {
+    int t = cache->cfg.prefetch.level;
+    cache_level_t *lvl = &cache->levels[t];
+    uint64_t lat = 0;
+    int src = -1;
 
-    /* EVICTION */
-    int victim = 0;
-    uint64_t min_time = UINT64_MAX;
+    for (int i = 0; i <= t; i++) {
+        if (cache_level_holds(&cache->levels[i], line))
+            return;
+    }
 
-    for (int i = 0; i < lvl->associativity; i++) {
-        cache_line_t *line = &set->lines[i];
-        uint64_t t = (lvl->policy == CACHE_FIFO)
-                         ? line->insertion_time
-                         : line->lru_time;
-        if (t < min_time) {
-            min_time = t;
-            victim = i;
+    /* the data arrives after the levels below it are walked */
+    for (int i = t + 1; i < cache->num_levels; i++) {
+        lat += cache->levels[i].latency;
+        if (cache_level_holds(&cache->levels[i], line)) {
+            src = i;
+            break;
         }
     }
+    if (src < 0)
+        lat += cache->cfg.ram_latency;
+
+    lvl->pf_filling = 1;
+    lvl->pf_fill_ready = cache->total_cycles + lat;
+    int lowest = cache_fill_levels(cache, line, 0, t, src);
+    lvl->pf_filling = 0;
 
-    set->lines[victim].tag = tag;
-    set->lines[victim].dirty = is_write;
-    set->lines[victim].insertion_time = lvl->global_time;
-    set->lines[victim].lru_time = lvl->global_time;
+    if (src < 0 && lowest >= 0)
+        cache->ram_read_bytes += cache->levels[lowest].block_size;
+    cache->pf_issued++;
 
+    if (cache->verbose)
+        printf("-> Prefetch 0x%llx into %s\n", (unsigned long long)line, lvl->name);
+}
+
+/* A demand access used a prefetched line for the first time; returns stall */
+static uint64_t pf_first_use(cache_t *cache, cache_level_t *lvl, uint64_t set,
+                             int way, uint64_t now) {
+    uint64_t ready = lvl->pf_ready[set * lvl->associativity + way];
+
+    lvl->pf_bits[set] &= ~(1ULL << way);
+    if (ready > now) {
+        cache->pf_late++;
+        return ready - now;
+    }
+    cache->pf_useful++;
     return 0;
 }
 
+/* Demand miss at the prefetch level: was the line pushed out by a prefetch? */
+static void pf_check_pollution(cache_t *cache, cache_level_t *lvl, uint64_t address) {
+    uint64_t line = address >> lvl->line_shift;
+    uint64_t *slot = &lvl->pf_victims[line & (PF_VICTIMS - 1)];
+
+    if (*slot == line + 1) {
+        cache->pf_polluting++;
+        *slot = 0;
+    }
+}
+
+static void cache_prefetch(cache_t *cache, uint64_t address) {
+    uint64_t lines[CACHE_PF_MAX_DEGREE];
+    int n = prefetcher_train(&cache->pf, address, lines);
+
+    for (int k = 0; k < n; k++)
+        cache_prefetch_line(cache, lines[k]);
+}
+
 /* =========================
    PUBLIC API
    ========================= */
 
-void cache_init(void) {
-    memset(&cache, 0, sizeof(cache));
+cache_t *cache_create(const cache_config_t *cfg) {
+    if (cache_validate_config(cfg) != 0)
+        return NULL;
+
+    cache_t *cache = calloc(1, sizeof(*cache));
+    if (!cache)
+        return NULL;
 
-    cache_level_init(&cache.l1, "L1", 1024, 64, 2, CACHE_LRU);
-    cache_level_init(&cache.l2, "L2", 4096, 64, 4, CACHE_LRU);
-    cache_level_init(&cache.l3, "L3", 16384, 64, 8, CACHE_FIFO);
+    cache->cfg = *cfg;
+    cache->num_levels = cfg->num_levels;
+
+    /* MEMSIM_SIMD=scalar|sse2|avx2 pins the kernels, e.g. to compare them */
+    const cache_simd_t *simd = cache_simd_select(getenv("MEMSIM_SIMD"));
+
+    for (int i = 0; i < cfg->num_levels; i++) {
+        if (cache_level_init(&cache->levels[i], &cfg->levels[i], simd) != 0) {
+            cache_shutdown(cache);
+            return NULL;
+        }
+    }
+
+    if (cfg->prefetch.type != CACHE_PF_NONE) {
+        cache_level_t *lvl = &cache->levels[cfg->prefetch.level];
+
+        prefetcher_init(&cache->pf, &cfg->prefetch, lvl->line_shift);
+        lvl->pf_bits = calloc((size_t)lvl->num_sets, sizeof(uint64_t));
+        lvl->pf_ready = calloc((size_t)lvl->num_sets * lvl->associativity,
+                               sizeof(uint64_t));
+        lvl->pf_victims = calloc(PF_VICTIMS, sizeof(uint64_t));
+        if (!lvl->pf_bits || !lvl->pf_ready || !lvl->pf_victims) {
+            cache_shutdown(cache);
+            return NULL;
+        }
+    }
+    return cache;
 }
 
-void cache_shutdown(void) {
-    cache_level_free(&cache.l1);
-    cache_level_free(&cache.l2);
-    cache_level_free(&cache.l3);
+cache_t *cache_init(void) {
+    cache_config_t cfg;
+
+    cache_default_config(&cfg);
+    return cache_create(&cfg);
 }
 
-void cache_access(uint64_t address, int is_write) {
-    cache.total_requests++;
+void cache_shutdown(cache_t *cache) {
+    if (!cache)
+        return;
 
-    printf("\nCPU %s Request: 0x%llx\n",
-           is_write ? "WRITE" : "READ",
-           (unsigned long long)address);
+    for (int i = 0; i < cache->num_levels; i++)
+        cache_level_free(&cache->levels[i]);
+    free(cache);
+}
 
-    uint64_t cost = L1_LATENCY;
+/* Walk the levels down to RAM; prints each step only in verbose mode */
+static void cache_access_one(cache_t *cache, uint64_t address, int is_write) {
+    int verbose = cache->verbose;
+    uint64_t cost = 0;
+    int hit = -1;
 
-    if (cache_level_access(&cache.l1, address, is_write)) {
-        printf("-> L1 Hit (Cost: %llu cycles)\n",
-               (unsigned long long)cost);
-        cache.total_cycles += cost;
-        return;
+    cache->total_requests++;
+
+    if (verbose)
+        printf("\nCPU %s Request: 0x%llx\n",
+               is_write ? "WRITE" : "READ",
+               (unsigned long long)address);
+
+    /* a write hit in a write-back L1 is the common case: dirty it here */
+    int l1_absorbs = is_write && cache->levels[0].write_back;
+    int pf_level = (cache->cfg.prefetch.type != CACHE_PF_NONE)
+                   ? cache->cfg.prefetch.level : -1;
+    int pf_trigger = 0;
+
+    for (int i = 0; i < cache->num_levels; i++) {
+        cache_level_t *lvl = &cache->levels[i];
+        uint64_t set;
+
+        cost += lvl->latency;
+        int way = cache_level_lookup(lvl, address, l1_absorbs && i == 0, &set);
+        if (way >= 0) {
+            /* first use of a prefetched line: wait for it if still in flight */
+            if (i == pf_level && ((lvl->pf_bits[set] >> way) & 1)) {
+                cost += pf_first_use(cache, lvl, set, way, cache->total_cycles + cost);
+                pf_trigger = 1;
+            }
+            if (verbose)
+                printf("-> %s Hit (Cost: %llu cycles)\n",
+                       lvl->name, (unsigned long long)cost);
+            hit = i;
+            break;
+        }
+
+        if (verbose && i < cache->num_levels - 1)
+            printf("-> %s Miss\n", lvl->name);
+        else if (verbose)
+            printf("-> %s Miss (Accessing Main Memory)\n", lvl->name);
     }
-    printf("-> L1 Miss\n");
 
-    cost += L2_LATENCY;
-    if (cache_level_access(&cache.l2, address, is_write)) {
-        printf("-> L2 Hit (Cost: %llu cycles)\n",
-               (unsigned long long)cost);
-        cache.total_cycles += cost;
-        return;
+    if (hit < 0) {
+        cost += cache->cfg.ram_latency;
+        if (verbose)
+            printf("-> Main Memory Access (Total Cost: %llu cycles)\n",
+                   (unsigned long long)cost);
     }
-    printf("-> L2 Miss\n");
 
-    cost += L3_LATENCY;
-    if (cache_level_access(&cache.l3, address, is_write)) {
-        printf("-> L3 Hit (Cost: %llu cycles)\n",
-               (unsigned long long)cost);
-        cache.total_cycles += cost;
-        return;
+    /* misses at the prefetch level train the prefetcher too */
+    if (pf_level >= 0 && (hit < 0 || hit > pf_level)) {
+        pf_check_pollution(cache, &cache->levels[pf_level], address);
+        pf_trigger = 1;
+    }
+
+    if (hit != 0) {
+        int lowest = cache_fill_levels(cache, address, is_write, 0, hit);
+
+        if (hit < 0 && lowest >= 0)
+            cache->ram_read_bytes += cache->levels[lowest].block_size;
     }
 
-    printf("-> L3 Miss (Accessing Main Memory)\n");
+    if (is_write && !(hit == 0 && l1_absorbs))
+        cache_write_down(cache, 0, address, CACHE_WORD_BYTES);
 
-    cost += RAM_LATENCY;
-    printf("-> Main Memory Access (Total Cost: %llu cycles)\n",
-           (unsigned long long)cost);
+    cache->total_cycles += cost;
 
-    cache.total_cycles += cost;
+    if (pf_trigger)
+        cache_prefetch(cache, address);
 }
 
-void cache_report_stats(void) {
-    printf("\n========== CACHE STATS ==========\n");
+void cache_set_verbose(cache_t *cache, int on) {
+    cache->verbose = (on != 0);
+}
 
-    cache_level_t *levels[3] = {&cache.l1, &cache.l2, &cache.l3};
+void cache_access(cache_t *cache, uint64_t address, int is_write) {
+    cache_access_one(cache, address, is_write);
+}
 
-    for (int i = 0; i < 3; i++) {
-        cache_level_t *lvl = levels[i];
+void cache_access_batch(cache_t *cache, const uint64_t *addrs,
+                        const uint8_t *is_write, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        cache_access_one(cache, addrs[i], is_write ? is_write[i] : CACHE_READ);
+}
+
+void cache_report_stats(const cache_t *cache) {
+    printf("\n========== CACHE STATS ==========\n");
+
+    for (int i = 0; i < cache->num_levels; i++) {
+        const cache_level_t *lvl = &cache->levels[i];
         uint64_t total = lvl->hits + lvl->misses;
         double rate = total ? (double)lvl->hits / total * 100.0 : 0.0;
 
-        printf("[%s] Hits: %llu  Misses: %llu  HitRate: %.2f%%\n",
+        printf("[%s] Hits: %llu  Misses: %llu  HitRate: %.2f%%  Writebacks: %llu\n",
                lvl->name,
                (unsigned long long)lvl->hits,
                (unsigned long long)lvl->misses,
-               rate);
+               rate,
+               (unsigned long long)lvl->writebacks);
     }
 
     printf("---------------------------------\n");
-    printf("Total Requests : %llu\n", (unsigned long long)cache.total_requests);
-    printf("Total Cycles   : %llu\n", (unsigned long long)cache.total_cycles);
+    printf("Total Requests : %llu\n", (unsigned long long)cache->total_requests);
+    printf("Total Cycles   : %llu\n", (unsigned long long)cache->total_cycles);
 
-    if (cache.total_requests > 0) {
+    if (cache->total_requests > 0) {
         double amat =
-            (double)cache.total_cycles / cache.total_requests;
+            (double)cache->total_cycles / cache->total_requests;
         printf("AMAT           : %.2f cycles\n", amat);
     }
+    printf("RAM Read       : %llu bytes\n", (unsigned long long)cache->ram_read_bytes);
+    printf("RAM Written    : %llu bytes\n", (unsigned long long)cache->ram_write_bytes);
+
+    if (cache->cfg.prefetch.type != CACHE_PF_NONE) {
+        const cache_prefetch_config_t *pf = &cache->cfg.prefetch;
+        uint64_t used = cache->pf_useful + cache->pf_late;
+
+        printf("---------------------------------\n");
+        printf("Prefetch       : %s into %s\n",
+               prefetch_names[pf->type], cache->levels[pf->level].name);
+        printf("Issued: %llu  Useful: %llu  Late: %llu  Unused: %llu  Polluting: %llu\n",
+               (unsigned long long)cache->pf_issued,
+               (unsigned long long)cache->pf_useful,
+               (unsigned long long)cache->pf_late,
+               (unsigned long long)cache->levels[pf->level].pf_unused,
+               (unsigned long long)cache->pf_polluting);
+        if (cache->pf_issued > 0)
+            printf("Accuracy       : %.2f%%\n",
+                   (double)used / cache->pf_issued * 100.0);
+    }
 
     printf("=================================\n");
 }
@@ -12,25 +12,111 @@
 #define CACHE_READ   0
 #define CACHE_WRITE  1
 
-/* Latencies (in cycles) */
+/* Default latencies (in cycles) */
 #define L1_LATENCY   1
 #define L2_LATENCY   5
 #define L3_LATENCY   20
 #define RAM_LATENCY  100
 
 /* Replacement policies */
-#define CACHE_LRU    0
-#define CACHE_FIFO  1
+#define CACHE_LRU     0
+#define CACHE_FIFO    1
+#define CACHE_PLRU    2   /* tree pseudo-LRU; power-of-two associativity */
+#define CACHE_SRRIP   3   /* static re-reference interval prediction, 2-bit */
+#define CACHE_BRRIP   4   /* bimodal RRIP: most fills predicted distant */
+#define CACHE_LFU     5   /* least frequently used, 8-bit aging counters */
+#define CACHE_RANDOM  6
+
+/* Write hits: keep the line dirty until eviction, or pass every write down */
+#define CACHE_WRITE_BACK     0
+#define CACHE_WRITE_THROUGH  1
+
+/* Write misses: bring the line in first, or send the write straight down */
+#define CACHE_WRITE_ALLOCATE     0
+#define CACHE_NO_WRITE_ALLOCATE  1
+
+/* Bytes one access writes, for write-through traffic */
+#define CACHE_WORD_BYTES 8
+
+/* Inclusion between levels */
+#define CACHE_NINE       0   /* non-inclusive non-exclusive: fill every level that missed */
+#define CACHE_INCLUSIVE  1   /* evicting from a level evicts the line from the levels above */
+#define CACHE_EXCLUSIVE  2   /* a line lives in one level; victims move down a level */
+
+#define CACHE_MAX_LEVELS 8
+
+/* Prefetchers */
+#define CACHE_PF_NONE       0
+#define CACHE_PF_NEXT_LINE  1   /* the lines after each trigger */
+#define CACHE_PF_STRIDE     2   /* constant stride per 4 KB region */
+#define CACHE_PF_STREAM     3   /* stream-buffer style ascending / descending runs */
+
+#define CACHE_PF_MAX_DEGREE 16
+
+typedef struct {
+    char     name[8];             /* e.g. L1, L2, LLC */
+    size_t   size;                /* total bytes */
+    size_t   line_size;           /* bytes per line */
+    int      assoc;               /* ways per set */
+    int      policy;              /* CACHE_LRU, CACHE_FIFO, ... */
+    uint32_t latency;             /* cycles to probe this level */
+    int      write_policy;        /* CACHE_WRITE_BACK / CACHE_WRITE_THROUGH */
+    int      write_miss;          /* CACHE_WRITE_ALLOCATE / CACHE_NO_WRITE_ALLOCATE */
+} cache_level_config_t;
+
+/*
+ * A prefetcher watches the accesses that reach 'level' (misses there and
+ * first uses of lines it prefetched) and fills that level ahead of them.
+ */
+typedef struct {
+    int      type;                /* CACHE_PF_NONE, ... */
+    int      level;               /* index of the level it fills */
+    int      degree;              /* lines per trigger, 1..CACHE_PF_MAX_DEGREE */
+    int      distance;            /* lines between the trigger and the first prefetch */
+} cache_prefetch_config_t;
+
+/* Whole hierarchy, closest level to the CPU first */
+typedef struct {
+    int                     num_levels;
+    cache_level_config_t    levels[CACHE_MAX_LEVELS];
+    uint32_t                ram_latency;
+    int                     inclusion;   /* CACHE_NINE / CACHE_INCLUSIVE / CACHE_EXCLUSIVE */
+    cache_prefetch_config_t prefetch;
+} cache_config_t;
+
+/* The built-in L1/L2/L3 hierarchy */
+void cache_default_config(cache_config_t *cfg);
+
+/*
+ * Read a hierarchy description (format in cache.c). On error prints the
+ * offending line to stderr and returns -1, leaving *cfg untouched.
+ */
+int cache_load_config(const char *path, cache_config_t *cfg);
+
+/* 0 if every level has a usable geometry */
+int cache_validate_config(const cache_config_t *cfg);
+
+void cache_print_config(const cache_config_t *cfg);
+
+/* =========================
+   CACHE HANDLE
+   ========================= */
+
+/* One simulated hierarchy; independent instances never share state */
+typedef struct cache_controller cache_t;
 
 /* =========================
    CACHE LIFECYCLE
    ========================= */
 
-/* Initialize all cache levels (L1/L2/L3) */
-void cache_init(void);
+/* Create a hierarchy with the default levels; NULL on failure */
+cache_t *cache_init(void);
+
+/* Create a hierarchy from a description; NULL on failure */
+cache_t *cache_create(const cache_config_t *cfg);
 
 /* Free all cache memory */
-void cache_shutdown(void);
+void cache_shutdown(cache_t *cache);
 
 /* =========================
    CACHE ACCESS (CORE API)
@@ -42,13 +128,25 @@ void cache_shutdown(void);
  * address  : physical memory address
  * is_write : CACHE_READ or CACHE_WRITE
  */
-void cache_access(uint64_t address, int is_write);
+void cache_access(cache_t *cache, uint64_t address, int is_write);
+
+/*
+ * Simulate n accesses in order. is_write[i] is CACHE_READ/CACHE_WRITE;
+ * a NULL is_write means all reads. Only the counters are updated, so
+ * this is the path for large address streams.
+ */
+void cache_access_batch(cache_t *cache, const uint64_t *addrs,
+                        const uint8_t *is_write, size_t n);
+
+/* Verbose mode prints every access as it walks the levels (debug);
+   off by default */
+void cache_set_verbose(cache_t *cache, int on);
 
 /* =========================
    CACHE STATS / REPORTING
    ========================= */
 
-/* Print cache statistics for all levels */
-void cache_report_stats(void);
+/* Print per-level statistics, cycles, RAM traffic and prefetch results */
+void cache_report_stats(const cache_t *cache);
 
 #endif /* CACHE_H */
@@ -0,0 +1,164 @@
+#include "cache_simd.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CACHE_SIMD_X86 1
+#endif
+
+/* =========================
+   SCALAR
+   ========================= */
+
+static uint64_t tag_match_scalar(const uint64_t *tags, int ways, uint64_t tag) {
+    uint64_t m = 0;
+    for (int w = 0; w < ways; w++)
+        m |= (uint64_t)(tags[w] == tag) << w;
+    return m;
+}
+
+static uint64_t age_match_scalar(const uint8_t *age, int ways, uint8_t value) {
+    uint64_t m = 0;
+    for (int w = 0; w < ways; w++)
+        m |= (uint64_t)(age[w] == value) << w;
+    return m;
+}
+
+static void age_bump_scalar(uint8_t *age, int ways, uint8_t below) {
+    for (int w = 0; w < ways; w++)
+        age[w] += (age[w] < below);
+}
+
+static const cache_simd_t simd_scalar = {
+    "scalar", tag_match_scalar, age_match_scalar, age_bump_scalar
+};
+
+#ifdef CACHE_SIMD_X86
+
+/* =========================
+   SSE2
+   ========================= */
+
+__attribute__((target("sse2")))
+static uint64_t tag_match_sse2(const uint64_t *tags, int ways, uint64_t tag) {
+    __m128i t = _mm_set1_epi64x((long long)tag);
+    uint64_t m = 0;
+
+    /* no 64-bit compare in SSE2: both 32-bit halves must match */
+    for (int w = 0; w < ways; w += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(tags + w));
+        __m128i e = _mm_cmpeq_epi32(v, t);
+        e = _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        m |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(e)) << w;
+    }
+    return m;
+}
+
+__attribute__((target("sse2")))
+static uint64_t age_match_sse2(const uint8_t *age, int ways, uint8_t value) {
+    __m128i x = _mm_set1_epi8((char)value);
+    uint64_t m = 0;
+
+    for (int w = 0; w < ways; w += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(age + w));
+        m |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, x)) << w;
+    }
+    return m;
+}
+
+__attribute__((target("sse2")))
+static void age_bump_sse2(uint8_t *age, int ways, uint8_t below) {
+    __m128i b = _mm_set1_epi8((char)below);
+    int w = 0;
+
+    /* lanes that are < below hold -1, so subtracting adds one */
+    for (; w + 16 <= ways; w += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(age + w));
+        v = _mm_sub_epi8(v, _mm_cmplt_epi8(v, b));
+        _mm_storeu_si128((__m128i *)(age + w), v);
+    }
+    age_bump_scalar(age + w, ways - w, below);
+}
+
+static const cache_simd_t simd_sse2 = {
+    "sse2", tag_match_sse2, age_match_sse2, age_bump_sse2
+};
+
+/* =========================
+   AVX2
+   ========================= */
+
+__attribute__((target("avx2")))
+static uint64_t tag_match_avx2(const uint64_t *tags, int ways, uint64_t tag) {
+    __m256i t = _mm256_set1_epi64x((long long)tag);
+    uint64_t m = 0;
+
+    for (int w = 0; w < ways; w += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(tags + w));
+        __m256i e = _mm256_cmpeq_epi64(v, t);
+        m |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(e)) << w;
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+static uint64_t age_match_avx2(const uint8_t *age, int ways, uint8_t value) {
+    __m256i x = _mm256_set1_epi8((char)value);
+    uint64_t m = 0;
+
+    for (int w = 0; w < ways; w += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(age + w));
+        m |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, x)) << w;
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+static void age_bump_avx2(uint8_t *age, int ways, uint8_t below) {
+    __m256i b = _mm256_set1_epi8((char)below);
+    int w = 0;
+
+    for (; w + 32 <= ways; w += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(age + w));
+        v = _mm256_sub_epi8(v, _mm256_cmpgt_epi8(b, v));
+        _mm256_storeu_si256((__m256i *)(age + w), v);
+    }
+    /* inline tail: calling the legacy-SSE kernel here would mix encodings */
+    for (; w < ways; w++)
+        age[w] += (age[w] < below);
+}
+
+static const cache_simd_t simd_avx2 = {
+    "avx2", tag_match_avx2, age_match_avx2, age_bump_avx2
+};
+
+#endif /* CACHE_SIMD_X86 */
+
+/* =========================
+   SELECTION
+   ========================= */
+
+const cache_simd_t *cache_simd_select(const char *force) {
+    const cache_simd_t *best = &simd_scalar;
+
+#ifdef CACHE_SIMD_X86
+    __builtin_cpu_init();
+    int has_sse2 = __builtin_cpu_supports("sse2");
+    int has_avx2 = __builtin_cpu_supports("avx2");
+
+    if (has_avx2)
+        best = &simd_avx2;
+    else if (has_sse2)
+        best = &simd_sse2;
+
+    if (force && strcmp(force, "sse2") == 0 && has_sse2)
+        return &simd_sse2;
+    if (force && strcmp(force, "avx2") == 0 && has_avx2)
+        return &simd_avx2;
+#endif
+
+    if (force && strcmp(force, "scalar") == 0)
+        return &simd_scalar;
+    return best;
+}
@@ -0,0 +1,37 @@
+#ifndef CACHE_SIMD_H
+#define CACHE_SIMD_H
+
+#include <stdint.h>
+
+/*
+ * Vector kernels for one cache set. Each works on a row of 'ways'
+ * entries and returns / updates per-way results; the caller masks the
+ * returned bitmasks to the ways that exist.
+ *
+ * Reads may run past the end of a row (up to CACHE_SIMD_PAD_TAGS tags
+ * or CACHE_SIMD_PAD_AGES ages), so the arrays need that much padding
+ * after the last set. Writes never leave the row.
+ */
+#define CACHE_SIMD_PAD_TAGS  4
+#define CACHE_SIMD_PAD_AGES  32
+
+typedef struct {
+    const char *name;
+
+    /* bit w set if tags[w] == tag */
+    uint64_t (*tag_match)(const uint64_t *tags, int ways, uint64_t tag);
+
+    /* bit w set if age[w] == value */
+    uint64_t (*age_match)(const uint8_t *age, int ways, uint8_t value);
+
+    /* age[w]++ for every age[w] < below (ages are 0..127) */
+    void (*age_bump)(uint8_t *age, int ways, uint8_t below);
+} cache_simd_t;
+
+/*
+ * Best implementation for this CPU (AVX2, SSE2, else scalar), or the one
+ * named by 'force' ("avx2", "sse2", "scalar") if the CPU supports it.
+ */
+const cache_simd_t *cache_simd_select(const char *force);
+
+#endif /* CACHE_SIMD_H */
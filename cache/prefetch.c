@@ -0,0 +1,124 @@
+#include "prefetch.h"
+
+#include <string.h>
+
+void prefetcher_init(prefetcher_t *pf, const cache_prefetch_config_t *cfg,
+                     unsigned line_shift) {
+    memset(pf, 0, sizeof(*pf));
+    pf->type = cfg->type;
+    pf->degree = cfg->degree;
+    pf->distance = cfg->distance;
+    pf->line_shift = line_shift;
+}
+
+/* 'degree' lines 'step' lines apart, starting 'distance' steps past 'line' */
+static int emit_run(const prefetcher_t *pf, uint64_t line, int64_t step,
+                    uint64_t *lines) {
+    for (int k = 0; k < pf->degree; k++)
+        lines[k] = (line + (uint64_t)(step * (pf->distance + k))) << pf->line_shift;
+    return pf->degree;
+}
+
+/* =========================
+   STRIDE
+   ========================= */
+
+static int train_stride(prefetcher_t *pf, uint64_t address, uint64_t *lines) {
+    uint64_t region = address >> PF_REGION_SHIFT;
+    pf_stride_entry_t *e = NULL, *oldest = &pf->strides[0];
+
+    for (int i = 0; i < PF_STRIDE_ENTRIES; i++) {
+        pf_stride_entry_t *s = &pf->strides[i];
+
+        if (s->valid && s->region == region) {
+            e = s;
+            break;
+        }
+        if (!s->valid || s->stamp < oldest->stamp)
+            oldest = s;
+    }
+
+    if (!e) {
+        *oldest = (pf_stride_entry_t){ .region = region, .last = address,
+                                       .valid = 1, .stamp = ++pf->clock };
+        return 0;
+    }
+
+    int64_t d = (int64_t)(address - e->last);
+    if (d == 0)
+        return 0;
+
+    /* a mismatch first costs confidence, then replaces the stride */
+    if (d == e->stride) {
+        if (e->conf < 3)
+            e->conf++;
+    } else if (e->conf > 0) {
+        e->conf--;
+    } else {
+        e->stride = d;
+    }
+    e->last = address;
+    e->stamp = ++pf->clock;
+
+    if (e->conf < 2)
+        return 0;
+
+    /* line-aligned targets; sub-line strides collapse into one line */
+    int n = 0;
+    uint64_t prev = address >> pf->line_shift;
+    for (int k = 0; k < pf->degree; k++) {
+        uint64_t line = (address + (uint64_t)(e->stride * (pf->distance + k))) >> pf->line_shift;
+
+        if (line != prev)
+            lines[n++] = line << pf->line_shift;
+        prev = line;
+    }
+    return n;
+}
+
+/* =========================
+   STREAM
+   ========================= */
+
+static int train_stream(prefetcher_t *pf, uint64_t address, uint64_t *lines) {
+    uint64_t line = address >> pf->line_shift;
+    pf_stream_t *oldest = &pf->streams[0];
+
+    for (int i = 0; i < PF_STREAMS; i++) {
+        pf_stream_t *s = &pf->streams[i];
+
+        if (s->valid) {
+            int64_t d = (int64_t)(line - s->last);
+
+            if (s->dir == 0 && (d == 1 || d == -1))
+                s->dir = (int)d;
+            if (s->dir != 0 && d * s->dir >= 1 && d * s->dir <= PF_STREAM_WINDOW) {
+                s->last = line;
+                s->stamp = ++pf->clock;
+                return emit_run(pf, line, s->dir, lines);
+            }
+        }
+        if (!s->valid || s->stamp < oldest->stamp)
+            oldest = s;
+    }
+
+    *oldest = (pf_stream_t){ .last = line, .valid = 1, .stamp = ++pf->clock };
+    return 0;
+}
+
+/* =========================
+   DISPATCH
+   ========================= */
+
+int prefetcher_train(prefetcher_t *pf, uint64_t address, uint64_t *lines) {
+    switch (pf->type) {
+    case CACHE_PF_NEXT_LINE:
+        return emit_run(pf, address >> pf->line_shift, 1, lines);
+    case CACHE_PF_STRIDE:
+        return train_stride(pf, address, lines);
+    case CACHE_PF_STREAM:
+        return train_stream(pf, address, lines);
+    default:
+        return 0;
+    }
+}
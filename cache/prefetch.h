@@ -0,0 +1,56 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdint.h>
+
+#include "cache.h"
+
+/*
+ * Prefetch address generators. A prefetcher only decides which lines to
+ * fetch; the cache issues the fills and keeps the statistics.
+ *
+ * The simulator sees addresses but no program counter, so the stride
+ * prefetcher keys its table by 4 KB region instead of by PC.
+ */
+#define PF_REGION_SHIFT   12
+#define PF_STRIDE_ENTRIES 16
+#define PF_STREAMS        8
+#define PF_STREAM_WINDOW  4     /* lines a stream may skip and still match */
+
+typedef struct {
+    uint64_t region;
+    uint64_t last;              /* last trigger address */
+    int64_t  stride;
+    int      conf;              /* 0..3, prefetches from 2 up */
+    int      valid;
+    uint64_t stamp;
+} pf_stride_entry_t;
+
+typedef struct {
+    uint64_t last;              /* last trigger line */
+    int      dir;               /* +1 / -1, 0 until a second miss confirms */
+    int      valid;
+    uint64_t stamp;
+} pf_stream_t;
+
+typedef struct {
+    int      type;              /* CACHE_PF_* */
+    int      degree;
+    int      distance;
+    unsigned line_shift;
+    uint64_t clock;             /* replacement stamps */
+
+    pf_stride_entry_t strides[PF_STRIDE_ENTRIES];
+    pf_stream_t       streams[PF_STREAMS];
+} prefetcher_t;
+
+void prefetcher_init(prefetcher_t *pf, const cache_prefetch_config_t *cfg,
+                     unsigned line_shift);
+
+/*
+ * Feed one trigger address. Writes up to CACHE_PF_MAX_DEGREE line-aligned
+ * addresses to prefetch into lines[] and returns how many.
+ */
+int prefetcher_train(prefetcher_t *pf, uint64_t address, uint64_t *lines);
+
+#endif /* PREFETCH_H */
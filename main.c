@@ -1,8 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "simulator/cli.h"
+#include "simulator/replay.h"
+#include "simulator/trace.h"
+
+/* Number in environment variable 'name': 1 if set, 0 if unset, -1
+   (reported) if it is not a number up to 'max' */
+static int env_number(const char *name, uint64_t max, uint64_t *out) {
+    const char *env = getenv(name);
+
+    if (!env)
+        return 0;
+    if (cli_parse_u64(env, 0, max, out) != 0) {
+        fprintf(stderr, "%s: not a valid number: %s\n", name, env);
+        return -1;
+    }
+    return 1;
+}
+
+/*
+ * memsim replay <trace> <heap-size> [allocator] [cache-config]
+ * batch mode, no prompt
+ */
+static int run_replay(int argc, char **argv) {
+    algo_t algo = ALGO_FIRST_FIT;
+    cache_config_t cfg;
+    replay_summary_t sum;
+    mem_heap_t *heap;
+    uint64_t bytes, max = 0, base;
+    int has_base;
+
+    cache_default_config(&cfg);
+
+    if (argc < 4 || argc > 6 || cli_parse_u64(argv[3], 10, SIZE_MAX, &bytes) != 0 ||
+        (argc > 4 && algo_from_name(argv[4], &algo) != 0)) {
+        fprintf(stderr, "usage: %s replay <trace> <heap-size> [first|next|best|worst|buddy|slab|tlsf] [cache-config]\n",
+                argv[0]);
+        return 2;
+    }
+    if (argc > 5 && cache_load_config(argv[5], &cfg) != 0)
+        return 2;
+
+    /* MEMSIM_HEAP_MAX=<bytes> lets the heap grow up to that size;
+       MEMSIM_BASE=<address> runs on simulated addresses from that base */
+    if (env_number("MEMSIM_HEAP_MAX", SIZE_MAX, &max) < 0 ||
+        (has_base = env_number("MEMSIM_BASE", UINT64_MAX, &base)) < 0)
+        return 2;
+
+    cache_t *cache = cache_create(&cfg);
+    int r = replay_trace(argv[2], algo, (size_t)bytes, (size_t)max, cache, NULL,
+                         has_base ? &base : NULL, &sum, &heap);
+
+    if (r == 0) {
+        printf("Replayed %s with %s\n", argv[2], algo_name(algo));
+        replay_print_summary(&sum);
+        mem_stats_print(heap);
+        if (cache)
+            cache_report_stats(cache);
+    }
+
+    mem_shutdown(heap);
+    cache_shutdown(cache);
+    return r == 0 ? 0 : 1;
+}
+
+/* memsim convert <cli-script> <trace> : CLI commands -> binary trace */
+static int run_convert(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s convert <cli-script> <trace>\n", argv[0]);
+        return 2;
+    }
+
+    long n = trace_convert_cli(argv[2], argv[3]);
+    if (n < 0) {
+        fprintf(stderr, "conversion failed\n");
+        return 1;
+    }
+
+    printf("Wrote %ld events to %s\n", n, argv[3]);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "replay") == 0)
+        return run_replay(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "convert") == 0)
+        return run_convert(argc, argv);
 
-int main(void) {
     printf("Memory Simulator \nType 'help' for commands\n");
     cli_run();
     return 0;
@@ -1,84 +1,187 @@
+#define _GNU_SOURCE
 #include "my_malloc.h"
 
 #include "allocator/allocator.h"
-#include "allocator/buddy.h"
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
 /* ================================
-   ID → POINTER (PUBLIC)
+   PER-THREAD CACHE (CONCURRENT MODE)
    ================================ */
 
-void *id_to_ptr(uint32_t id) {
-    if (id == 0)
-        return NULL;
+/*
+ * Each thread keeps a few recently freed blocks per size class and
+ * reuses them without touching the heap lock. Cacheable requests are
+ * rounded up to their class size, so any cached block of a class can
+ * serve any request in it. Caches are dropped when the bound heap or its
+ * generation changes (new heap or strategy switch; the switch has reset
+ * the heap, so the old IDs must not be freed) and flushed back to the
+ * heap when the thread exits.
+ */
+#define TCACHE_MIN_SHIFT 4      /* 16 bytes */
+#define TCACHE_CLASSES   6      /* 16 .. 512 bytes */
+#define TCACHE_DEPTH     16
+
+typedef struct {
+    void    *ptr[TCACHE_CLASSES][TCACHE_DEPTH];
+    uint32_t id[TCACHE_CLASSES][TCACHE_DEPTH];
+    int      count[TCACHE_CLASSES];
+    uint64_t generation;
+    int      registered;
+} tcache_t;
+
+static _Thread_local tcache_t tcache;
+
+static _Atomic(mem_heap_t *) default_heap;
+static atomic_int     concurrent_mode;
+static pthread_key_t  tcache_key;
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+
+static size_t class_size(int cls) {
+    return (size_t)1 << (cls + TCACHE_MIN_SHIFT);
+}
 
-    /* Buddy allocator */
-    if (get_allocator_algo() == ALGO_BUDDY) {
-        return buddy_allocated_address(id);
+static int class_for_size(size_t size) {
+    for (int c = 0; c < TCACHE_CLASSES; c++) {
+        if (class_size(c) >= size)
+            return c;
     }
+    return -1;
+}
 
-    /* First / Best / Worst Fit */
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
-    uint8_t *base = allocator_get_base();
+static mem_heap_t *bound_heap(void) {
+    return atomic_load_explicit(&default_heap, memory_order_acquire);
+}
+
+/* Generations are unique across heaps, so a match means same heap */
+static void tcache_flush(tcache_t *tc) {
+    mem_heap_t *heap = bound_heap();
+    int live = heap && tc->generation == mem_generation(heap);
 
-    for (size_t i = 0; i < count; i++) {
-        if (!blocks[i].free && blocks[i].id == id) {
-            return base + blocks[i].offset;
+    for (int c = 0; c < TCACHE_CLASSES; c++) {
+        while (tc->count[c] > 0) {
+            tc->count[c]--;
+            if (live)
+                mem_free(heap, tc->id[c][tc->count[c]]);
         }
     }
+}
 
-    return NULL;
+static void tcache_destructor(void *arg) {
+    tcache_flush((tcache_t *)arg);
 }
 
-/* ================================
-   POINTER → ID (LIMITED)
-   ================================ */
+static void tcache_key_init(void) {
+    pthread_key_create(&tcache_key, tcache_destructor);
+}
 
-static uint32_t ptr_to_id(void *ptr) {
-    if (!ptr)
-        return 0;
+/* This thread's cache, emptied if it belongs to an older heap */
+static tcache_t *tcache_get(mem_heap_t *heap) {
+    tcache_t *tc = &tcache;
+    uint64_t gen = mem_generation(heap);
 
-    /* Buddy allocator does NOT support reverse lookup safely */
-    if (get_allocator_algo() == ALGO_BUDDY) {
-        return 0;
+    if (!tc->registered) {
+        pthread_once(&tcache_once, tcache_key_init);
+        pthread_setspecific(tcache_key, tc);
+        tc->registered = 1;
     }
 
-    /* First / Best / Worst Fit */
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
-    uint8_t *base = allocator_get_base();
-
-    for (size_t i = 0; i < count; i++) {
-        if (!blocks[i].free) {
-            void *payload = base + blocks[i].offset;
-            if (payload == ptr)
-                return blocks[i].id;
-        }
+    if (tc->generation != gen) {
+        for (int c = 0; c < TCACHE_CLASSES; c++)
+            tc->count[c] = 0;
+        tc->generation = gen;
     }
+    return tc;
+}
+
+/* ================================
+   ID → POINTER (PUBLIC)
+   ================================ */
+
+void *id_to_ptr(uint32_t id) {
+    mem_heap_t *heap = bound_heap();
+    return heap ? mem_id_to_ptr(heap, id) : NULL;
+}
+
+/* ================================
+   POINTER → ID
+   ================================ */
 
-    return 0;
+static uint32_t ptr_to_id(mem_heap_t *heap, void *ptr) {
+    return mem_ptr_to_id(heap, ptr);
 }
 
 /* ================================
    PUBLIC API
    ================================ */
 
+void my_malloc_set_heap(mem_heap_t *heap) {
+    atomic_store_explicit(&default_heap, heap, memory_order_release);
+}
+
+void my_malloc_set_concurrent(int on) {
+    atomic_store(&concurrent_mode, on != 0);
+}
+
+void my_thread_cache_flush(void) {
+    tcache_flush(&tcache);
+}
+
 void *my_malloc(size_t size) {
-    uint32_t id = mem_alloc(size);
+    mem_heap_t *heap = bound_heap();
+    int cls = -1;
+
+    if (!heap)
+        return NULL;
+
+    if (atomic_load_explicit(&concurrent_mode, memory_order_relaxed))
+        cls = class_for_size(size);
+
+    if (cls >= 0) {
+        tcache_t *tc = tcache_get(heap);
+
+        if (tc->count[cls] > 0)
+            return tc->ptr[cls][--tc->count[cls]];
+
+        size = class_size(cls);
+    }
+
+    uint32_t id = mem_alloc(heap, size);
     if (id == 0)
         return NULL;
 
-    return id_to_ptr(id);
+    return mem_id_to_ptr(heap, id);
 }
 
 void my_free(void *ptr) {
-    if (!ptr)
+    mem_heap_t *heap = bound_heap();
+
+    if (!ptr || !heap)
+        return;
+
+    uint32_t id = ptr_to_id(heap, ptr);
+    if (id == 0)
         return;
 
-    uint32_t id = ptr_to_id(ptr);
-    if (id != 0)
-        mem_free(id);
+    if (atomic_load_explicit(&concurrent_mode, memory_order_relaxed)) {
+        size_t req = mem_requested_size(heap, id);
+        int cls = class_for_size(req);
+
+        /* only blocks rounded to their class can be handed out again */
+        if (cls >= 0 && req == class_size(cls)) {
+            tcache_t *tc = tcache_get(heap);
+
+            if (tc->count[cls] < TCACHE_DEPTH) {
+                tc->ptr[cls][tc->count[cls]] = ptr;
+                tc->id[cls][tc->count[cls]] = id;
+                tc->count[cls]++;
+                return;
+            }
+        }
+    }
+
+    mem_free(heap, id);
 }
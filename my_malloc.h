@@ -3,8 +3,28 @@
 
 #include <stddef.h>
 
+#include "allocator/allocator.h"
+
+/*
+ * Heap that my_malloc/my_free serve from. Must be set before the first
+ * call; my_malloc returns NULL while no heap is bound. Unbind (NULL)
+ * before shutting the heap down.
+ */
+void my_malloc_set_heap(mem_heap_t *heap);
+
 /* Application-facing malloc/free wrapper */
 void *my_malloc(size_t size);
 void my_free(void *ptr);
 
+/*
+ * Concurrent mode: my_malloc/my_free are always safe to call from any
+ * thread (the heap is locked). With concurrent mode on, each thread
+ * also keeps a small cache of freed blocks per size class (<= 512 B)
+ * and serves matching requests from it without taking the lock.
+ */
+void my_malloc_set_concurrent(int on);
+
+/* Return this thread's cached blocks to the heap */
+void my_thread_cache_flush(void);
+
 #endif /* MY_MALLOC_H */
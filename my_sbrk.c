@@ -1,31 +1,20 @@
-/* Optional small arena helper (not required by allocator which uses malloc).
-   Provided for completeness in the project. */
+/* sbrk-style arena break; the region itself is reserved by the caller
+   (allocator/backing.c), so moving the break never copies or maps */
 
-#include <stdlib.h>
-#include <stdint.h>
+#include "my_sbrk.h"
 
-static uint8_t *arena = NULL;
-static size_t arena_size = 0;
-static size_t arena_offset = 0;
-
-int my_sbrk_init(size_t sz) {
-    if (arena) return -1;
-    arena = (uint8_t*)malloc(sz);
-    if (!arena) return -1;
-    arena_size = sz;
-    arena_offset = 0;
-    return 0;
+void my_sbrk_init(my_sbrk_t *s, uint8_t *base, size_t limit) {
+    s->base = base;
+    s->limit = limit;
+    s->brk = 0;
 }
 
-void *my_sbrk(size_t inc) {
-    if (!arena) return NULL;
-    if (arena_offset + inc > arena_size) return NULL;
-    void *p = arena + arena_offset;
-    arena_offset += inc;
-    return p;
-}
+void *my_sbrk(my_sbrk_t *s, ptrdiff_t inc) {
+    if (!s->base) return NULL;
+    if (inc > 0 && (size_t)inc > s->limit - s->brk) return NULL;
+    if (inc < 0 && (size_t)-inc > s->brk) return NULL;
 
-void my_sbrk_shutdown(void) {
-    if (arena) free(arena);
-    arena = NULL; arena_size = 0; arena_offset = 0;
+    void *old = s->base + s->brk;
+    s->brk = (size_t)((ptrdiff_t)s->brk + inc);
+    return old;
 }
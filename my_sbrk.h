@@ -0,0 +1,24 @@
+#ifndef MY_SBRK_H
+#define MY_SBRK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * sbrk-style break over a caller-reserved region: the arena is
+ * [base, base + brk) and moves up (or back down) within 'limit' bytes.
+ * Each heap keeps one over its reserved arena and grows through it.
+ */
+typedef struct {
+    uint8_t *base;
+    size_t   limit;     /* bytes reserved */
+    size_t   brk;       /* bytes in the arena */
+} my_sbrk_t;
+
+void my_sbrk_init(my_sbrk_t *s, uint8_t *base, size_t limit);
+
+/* Move the break by 'inc' bytes; returns the old break, or NULL if it
+   would leave [0, limit] */
+void *my_sbrk(my_sbrk_t *s, ptrdiff_t inc);
+
+#endif /* MY_SBRK_H */
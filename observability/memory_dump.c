@@ -1,86 +1,122 @@
 #include "memory_dump.h"
 #include "../allocator/allocator.h"
 #include "../allocator/buddy.h"
+#include "../allocator/slab.h"
 #include <stdio.h>
 #include <stdint.h>
 
-/* Buddy block header */
-typedef struct {
-    uint32_t id;              /* 0 if free */
-    uint32_t order;           /* block size = 2^order */
-    uint32_t requested_size;
-} buddy_hdr_t;
-
-void memory_dump(void)
+void memory_dump(mem_heap_t *heap)
 {
+    const buddy_pool_t *bp = allocator_get_buddy(heap);
+    const slab_pool_t *sp = allocator_get_slab(heap);
+
     printf("\n========== MEMORY DUMP ==========\n");
 
-    if (get_allocator_algo() == ALGO_BUDDY) {
+    if (get_allocator_algo(heap) == ALGO_BUDDY) {
 
-        uint8_t *heap_start = buddy_get_base();
-        size_t   heap_size  = buddy_get_size();
+        uint64_t heap_start = allocator_get_address_base(heap);
 
         size_t total_used = 0;
         size_t total_free = 0;
 
-        uintptr_t ptr = (uintptr_t)heap_start;
-        uintptr_t end = ptr + heap_size;
+        block_t b;
 
-        while (ptr < end) {
+        for (size_t off = 0; buddy_block_at(bp, off, &b) == 0; off += b.size) {
 
-            buddy_hdr_t *hdr = (buddy_hdr_t *)ptr;
-            size_t size = (1UL << hdr->order);
+            uint64_t start = heap_start + b.offset;
+            uint64_t stop  = start + b.size - 1;
 
-            uintptr_t start = ptr;
-            uintptr_t stop  = ptr + size - 1;
-
-            if (hdr->id == 0) {
+            if (b.free) {
                 printf("[0x%016lx - 0x%016lx] FREE (%zu bytes)\n",
                        (unsigned long)start,
                        (unsigned long)stop,
-                       size);
-                total_free += size;
+                       b.size);
+                total_free += b.size;
             } else {
                 printf("[0x%016lx - 0x%016lx] USED (%zu bytes)\n",
                        (unsigned long)start,
                        (unsigned long)stop,
-                       size);
-                total_used += size;
+                       b.size);
+                total_used += b.size;
             }
+        }
+
+        printf("--------------------------------\n");
+        printf("Total used memory : %zu bytes\n", total_used);
+        printf("Total free memory : %zu bytes\n", total_free);
+        return;
+    }
+
+    if (get_allocator_algo(heap) == ALGO_SLAB) {
+
+        uint64_t heap_start = allocator_get_address_base(heap);
+
+        size_t total_used = 0;
+        size_t total_free = 0;
+
+        int cls;
+        size_t used, slots;
+
+        for (size_t i = 0; slab_get_info(sp, i, &cls, &used, &slots) == 0; i++) {
 
-            ptr += size;
+            uint64_t start = heap_start + i * SLAB_SIZE;
+            uint64_t stop  = start + SLAB_SIZE - 1;
+
+            if (cls < 0) {
+                printf("[0x%016lx - 0x%016lx] FREE SLAB (%d bytes)\n",
+                       (unsigned long)start,
+                       (unsigned long)stop,
+                       SLAB_SIZE);
+                total_free += SLAB_SIZE;
+            } else {
+                size_t obj = SLAB_SIZE / slots;
+                printf("[0x%016lx - 0x%016lx] SLAB %zuB x %zu : %zu used\n",
+                       (unsigned long)start,
+                       (unsigned long)stop,
+                       obj, slots, used);
+                total_used += used * obj;
+                total_free += (slots - used) * obj;
+            }
         }
 
+        slab_class_stats_t cs;
+
         printf("--------------------------------\n");
+        for (int c = 0; slab_get_class_stats(sp, c, &cs) == 0; c++) {
+            if (!cs.slabs)
+                continue;
+            printf("Class %4zuB : %zu slabs, %zu/%zu slots, %zu bytes wasted\n",
+                   cs.obj_size, cs.slabs, cs.live_objs, cs.total_slots,
+                   cs.live_objs * cs.obj_size - cs.requested_bytes);
+        }
         printf("Total used memory : %zu bytes\n", total_used);
         printf("Total free memory : %zu bytes\n", total_free);
         return;
     }
 
-    block_t *blocks = allocator_get_blocks();
-    size_t   count  = allocator_get_block_count();
-    uint8_t *base   = allocator_get_base();
+    uint64_t base = allocator_get_address_base(heap);
 
     size_t total_used = 0;
     size_t total_free = 0;
 
-    for (size_t i = 0; i < count; i++) {
+    for (const block_t *b = allocator_first_block(heap); b;
+         b = allocator_next_block(heap, b)) {
 
-        uintptr_t start = (uintptr_t)(base + blocks[i].offset);
-        uintptr_t end   = start + blocks[i].size - 1;
+        uint64_t start = base + b->offset;
+        uint64_t end   = start + b->size - 1;
 
-        if (blocks[i].free) {
+        if (b->free) {
             printf("[0x%016lx - 0x%016lx] FREE (%zu bytes)\n",
                    (unsigned long)start,
                    (unsigned long)end,
-                   blocks[i].size);
-            total_free += blocks[i].size;
+                   b->size);
+            total_free += b->size;
         } else {
             printf("[0x%016lx - 0x%016lx] USED (%zu bytes)\n",
                    (unsigned long)start,
                    (unsigned long)end,
-                   blocks[i].size);
-            total_used += blocks[i].size;
+                   b->size);
+            total_used += b->size;
         }
     }
 
@@ -1,6 +1,8 @@
 #ifndef MEMORY_DUMP_H
 #define MEMORY_DUMP_H
 
-void memory_dump(void);
+#include "../allocator/allocator.h"
+
+void memory_dump(mem_heap_t *heap);
 
 #endif
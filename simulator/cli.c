@@ -2,22 +2,35 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
+#include <ctype.h>
 
 #include "cli.h"
-#include "cache.h"
+#include "../cache/cache.h"
+#include "../vm/vm.h"
 
 #include "../allocator/allocator.h"
-#include "../allocator/buddy.h"
 #include "../stats/stats.h"
+#include "replay.h"
+#include "sweep.h"
 
-#define MAX_CLI_ALLOCS 1024
+/* =========================
+   SESSION STATE
+   ========================= */
 
-typedef struct {
-    uint32_t id;
-    int in_use;
-} cli_alloc_t;
+/* The CLI drives one default heap and its cache hierarchy */
+static mem_heap_t *heap = NULL;
+static cache_t    *cache = NULL;
+static algo_t      cli_algo = ALGO_FIRST_FIT;   /* applied on init */
+static int         cache_verbose = 1;           /* per-access trace */
+static uint64_t    cli_base = 0;                /* simulated heap base ... */
+static int         cli_sim_base = 0;            /* ... if set, else host */
+static cache_config_t cache_cfg;                /* hierarchy for new caches */
 
-static cli_alloc_t alloc_table[MAX_CLI_ALLOCS];
+/* Optional paging layer in front of the cache (off by default) */
+static vm_t       *vm = NULL;
+static int         vm_enabled = 0;
+static vm_config_t vm_cfg;
 
 /* =========================
    HELPERS
@@ -28,59 +41,127 @@ static void print_prompt(void) {
     fflush(stdout);
 }
 
-static void reset_alloc_table(void) {
-    for (int i = 0; i < MAX_CLI_ALLOCS; i++) {
-        alloc_table[i].in_use = 0;
-        alloc_table[i].id = 0;
-    }
+int cli_parse_u64(const char *s, int base, uint64_t max, uint64_t *out) {
+    char *end;
+    unsigned long long v;
+
+    /* strtoull would skip blanks and take a sign, wrapping negatives */
+    if (!s || !isdigit((unsigned char)*s))
+        return -1;
+    errno = 0;
+    v = strtoull(s, &end, base);
+    if (end == s || *end != '\0' || errno == ERANGE || v > max)
+        return -1;
+    *out = v;
+    return 0;
 }
 
-static int store_alloc(uint32_t id) {
-    for (int i = 0; i < MAX_CLI_ALLOCS; i++) {
-        if (!alloc_table[i].in_use) {
-            alloc_table[i].in_use = 1;
-            alloc_table[i].id = id;
-            return 0;
-        }
-    }
-    return -1;
+/* Decimal byte count */
+static int parse_size(const char *s, size_t *out) {
+    uint64_t v;
+
+    if (cli_parse_u64(s, 10, SIZE_MAX, &v) != 0)
+        return -1;
+    *out = (size_t)v;
+    return 0;
 }
 
-static int has_alloc(uint32_t id) {
-    for (int i = 0; i < MAX_CLI_ALLOCS; i++) {
-        if (alloc_table[i].in_use && alloc_table[i].id == id)
-            return 1;
-    }
+/* Allocation ID as printed by malloc */
+static int parse_id(const char *s, uint32_t *out) {
+    uint64_t v;
+
+    if (cli_parse_u64(s, 10, UINT32_MAX, &v) != 0)
+        return -1;
+    *out = (uint32_t)v;
     return 0;
 }
 
-static void clear_alloc(uint32_t id) {
-    for (int i = 0; i < MAX_CLI_ALLOCS; i++) {
-        if (alloc_table[i].in_use && alloc_table[i].id == id) {
-            alloc_table[i].in_use = 0;
-            alloc_table[i].id = 0;
-            return;
-        }
-    }
+/* Signed decimal, for strides */
+static int parse_i64(const char *s, int64_t *out) {
+    uint64_t v;
+    int neg = s && *s == '-';
+
+    if (cli_parse_u64(neg ? s + 1 : s, 10, (uint64_t)INT64_MAX, &v) != 0)
+        return -1;
+    *out = neg ? -(int64_t)v : (int64_t)v;
+    return 0;
 }
 
-/* Resolve allocation ID → payload base address */
-static void *resolve_address(uint32_t id) {
-    if (get_allocator_algo() == ALGO_BUDDY) {
-        return buddy_allocated_address(id);
-    }
+/* Apply the configured address mode to the heap */
+static void apply_address_base(mem_heap_t *h) {
+    if (cli_sim_base)
+        mem_set_address_base(h, cli_base);
+    else
+        mem_use_host_addresses(h);
+}
 
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
-    uint8_t *base = allocator_get_base();
+/* Resolve allocation ID → payload address as simulated; 0 if not live */
+static int resolve_address(uint32_t id, uint64_t *addr) {
+    if (mem_id_to_address(heap, id, addr) == 0)
+        return 1;
+    printf("Invalid block id\n");
+    return 0;
+}
 
-    for (size_t i = 0; i < count; i++) {
-        if (!blocks[i].free && blocks[i].id == id) {
-            return base + blocks[i].offset;
-        }
+/* Physical address of a heap access (identity with the VM off) */
+static uint64_t translate(uint64_t addr, int is_write) {
+    return vm ? vm_translate(vm, addr, is_write) : addr;
+}
+
+/* Commands that touch the heap need it initialized first */
+static int require_heap(void) {
+    if (heap)
+        return 1;
+    printf("Memory not initialized\n");
+    return 0;
+}
+
+/* =========================
+   RANGE ACCESSES
+   ========================= */
+
+#define SWEEP_CHUNK 1024
+
+/* Base address and requested size of a live allocation */
+static int block_extent(const char *idstr, uint64_t *base, uint64_t *size) {
+    uint32_t id;
+
+    if (parse_id(idstr, &id) != 0) {
+        printf("Invalid block id\n");
+        return 0;
     }
+    if (!resolve_address(id, base))
+        return 0;
+    *size = mem_requested_size(heap, id);
+    return 1;
+}
 
-    return NULL;
+/* Run a sweep through the cache in batches, without the per-access
+   trace; returns the number of accesses */
+static uint64_t run_sweep(sweep_t *s, const uint64_t base[2]) {
+    uint64_t addrs[SWEEP_CHUNK];
+    uint8_t  writes[SWEEP_CHUNK];
+    uint64_t total = 0;
+    size_t n = 0;
+    sweep_step_t st;
+
+    cache_set_verbose(cache, 0);
+    while (sweep_next(s, &st)) {
+        addrs[n] = base[st.block] + st.offset;
+        writes[n] = st.is_write ? CACHE_WRITE : CACHE_READ;
+        if (++n == SWEEP_CHUNK) {
+            if (vm)
+                vm_translate_batch(vm, addrs, writes, n);
+            cache_access_batch(cache, addrs, writes, n);
+            total += n;
+            n = 0;
+        }
+    }
+    if (vm)
+        vm_translate_batch(vm, addrs, writes, n);
+    cache_access_batch(cache, addrs, writes, n);
+    cache_set_verbose(cache, cache_verbose);
+    return total + n;
 }
 
 /* =========================
@@ -90,6 +171,9 @@ static void *resolve_address(uint32_t id) {
 void cli_run(void) {
     char line[256];
 
+    cache_default_config(&cache_cfg);
+    vm_default_config(&vm_cfg);
+
     while (1) {
         print_prompt();
 
@@ -103,15 +187,25 @@ void cli_run(void) {
         /* help */
         if (strcmp(cmd, "help") == 0) {
             printf("Commands:\n");
-            printf("  init memory <size>\n");
-            printf("  set allocator <first|best|worst|buddy>\n");
+            printf("  init memory <size> [max-size]\n");
+            printf("  set allocator <first|next|best|worst|buddy|slab|tlsf>\n");
+            printf("  set base <address|host>\n");
             printf("  malloc <size>\n");
             printf("  free <id>\n");
             printf("  read <id> <offset>\n");
             printf("  write <id> <offset>\n");
+            printf("  scan <id> <stride> <count>\n");
+            printf("  random <id> <count> <seed>\n");
+            printf("  memcpy <src-id> <dst-id> <bytes>\n");
             printf("  dump\n");
             printf("  stats\n");
             printf("  cache_stats\n");
+            printf("  cache verbose <on|off>\n");
+            printf("  cache config [file]\n");
+            printf("  vm <on|off>\n");
+            printf("  vm config [key=value ...]\n");
+            printf("  vm_stats\n");
+            printf("  replay <trace> <heap-size> [max-size]\n");
             printf("  shutdown\n");
             printf("  exit | quit\n");
         }
@@ -120,18 +214,46 @@ void cli_run(void) {
         else if (strcmp(cmd, "init") == 0) {
             char *sub = strtok(NULL, " \n");
             char *sz  = strtok(NULL, " \n");
+            char *max = strtok(NULL, " \n");
 
-            if (!sub || !sz || strcmp(sub, "memory") != 0) {
-                printf("Usage: init memory <size>\n");
+            size_t size, limit;
+
+            if (!sub || strcmp(sub, "memory") != 0 || parse_size(sz, &size) != 0 ||
+                (max && parse_size(max, &limit) != 0)) {
+                printf("Usage: init memory <size> [max-size]\n");
                 continue;
             }
+            if (!max)
+                limit = size;
 
-            size_t size = (size_t)atoi(sz);
-            if (mem_init(size) == 0) {
-                reset_alloc_table();
-                cache_init();
-                printf("initialized memory: %zu bytes\n", size);
+            if (heap) {
+                printf("memory already initialized\n");
+                continue;
+            }
+
+            /* with a larger max the heap starts at 'size' and grows */
+            heap = limit > size ? mem_init_growable(size, limit) : mem_init(size);
+            cache = cache_create(&cache_cfg);
+            if (vm_enabled)
+                vm = vm_create(&vm_cfg);
+            if (!heap || !cache || (vm_enabled && !vm) ||
+                set_allocator_algo(heap, cli_algo) != 0) {
+                mem_shutdown(heap);
+                cache_shutdown(cache);
+                vm_destroy(vm);
+                heap = NULL;
+                cache = NULL;
+                vm = NULL;
+                printf("Initialization failed\n");
+                continue;
             }
+
+            apply_address_base(heap);
+            cache_set_verbose(cache, cache_verbose);
+            if (limit > size)
+                printf("initialized memory: %zu bytes, growable to %zu\n", size, limit);
+            else
+                printf("initialized memory: %zu bytes\n", size);
         }
 
         /* set allocator */
@@ -139,68 +261,93 @@ void cli_run(void) {
             char *sub = strtok(NULL, " \n");
             char *arg = strtok(NULL, " \n");
 
+            /* simulated heap base: addresses become base + offset */
+            if (sub && arg && strcmp(sub, "base") == 0) {
+                int host = strcmp(arg, "host") == 0;
+                uint64_t b = 0;
+
+                if (!host && cli_parse_u64(arg, 0, UINT64_MAX, &b) != 0) {
+                    printf("Usage: set base <address|host>\n");
+                    continue;
+                }
+
+                cli_base = b;
+                cli_sim_base = !host;
+                if (heap)
+                    apply_address_base(heap);
+
+                if (cli_sim_base)
+                    printf("Heap base set to 0x%016llx\n", (unsigned long long)cli_base);
+                else
+                    printf("Heap base set to host addresses\n");
+                continue;
+            }
+
             if (!sub || !arg || strcmp(sub, "allocator") != 0) {
-                printf("Usage: set allocator <first|best|worst|buddy>\n");
+                printf("Usage: set allocator <first|next|best|worst|buddy|slab|tlsf>"
+                       " | set base <address|host>\n");
                 continue;
             }
 
-            if (strcmp(arg, "first") == 0)
-                set_allocator_algo(ALGO_FIRST_FIT);
-            else if (strcmp(arg, "best") == 0)
-                set_allocator_algo(ALGO_BEST_FIT);
-            else if (strcmp(arg, "worst") == 0)
-                set_allocator_algo(ALGO_WORST_FIT);
-            else if (strcmp(arg, "buddy") == 0)
-                set_allocator_algo(ALGO_BUDDY);
-            else {
+            if (algo_from_name(arg, &cli_algo) != 0) {
                 printf("Unknown allocator strategy\n");
                 continue;
             }
 
+            if (heap && set_allocator_algo(heap, cli_algo) != 0) {
+                cli_algo = get_allocator_algo(heap);
+                printf("Allocator switch failed\n");
+                continue;
+            }
+
             printf("Allocator strategy set\n");
         }
 
         /* malloc */
         else if (strcmp(cmd, "malloc") == 0) {
             char *sz = strtok(NULL, " \n");
-            if (!sz) {
+            size_t size;
+
+            if (parse_size(sz, &size) != 0) {
                 printf("Usage: malloc <size>\n");
                 continue;
             }
 
-            size_t size = (size_t)atoi(sz);
-            uint32_t id = mem_alloc(size);
+            if (!require_heap())
+                continue;
+
+            uint32_t id = mem_alloc(heap, size);
 
             if (!id) {
                 printf("Allocation failed\n");
                 continue;
             }
 
-            store_alloc(id);
+            uint64_t addr = 0;
+            resolve_address(id, &addr);
 
-            void *addr = resolve_address(id);
-
-            printf("Allocated block id=%u at address=0x%016lx\n",
-                   id, (unsigned long)(uintptr_t)addr);
+            printf("Allocated block id=%u at address=0x%016llx\n",
+                   id, (unsigned long long)addr);
         }
 
         /* free */
         else if (strcmp(cmd, "free") == 0) {
             char *idstr = strtok(NULL, " \n");
-            if (!idstr) {
+            uint32_t id;
+
+            if (parse_id(idstr, &id) != 0) {
                 printf("Usage: free <id>\n");
                 continue;
             }
 
-            uint32_t id = (uint32_t)atoi(idstr);
+            if (!require_heap())
+                continue;
 
-            if (!has_alloc(id)) {
+            if (mem_free(heap, id) != 0) {
                 printf("Invalid block id\n");
                 continue;
             }
 
-            mem_free(id);
-            clear_alloc(id);
             printf("Block %u freed\n", id);
         }
 
@@ -211,53 +358,284 @@ void cli_run(void) {
             char *idstr = strtok(NULL, " \n");
             char *offstr = strtok(NULL, " \n");
 
-            if (!idstr || !offstr) {
+            uint32_t id;
+            size_t offset;
+
+            if (parse_id(idstr, &id) != 0 || parse_size(offstr, &offset) != 0) {
                 printf("Usage: %s <id> <offset>\n", cmd);
                 continue;
             }
 
-            uint32_t id = (uint32_t)atoi(idstr);
-            size_t offset = (size_t)atoi(offstr);
+            if (!require_heap())
+                continue;
 
-            if (!has_alloc(id)) {
-                printf("Invalid block id\n");
+            uint64_t base;
+            if (!resolve_address(id, &base))
+                continue;
+
+            uint64_t addr = base + offset;
+            uint64_t phys = translate(addr, is_write);
+            cache_access(cache, phys, is_write);
+
+            if (vm)
+                printf("%s access at address 0x%016llx (physical 0x%016llx)\n",
+                       is_write ? "WRITE" : "READ",
+                       (unsigned long long)addr, (unsigned long long)phys);
+            else
+                printf("%s access at address 0x%016llx\n",
+                       is_write ? "WRITE" : "READ",
+                       (unsigned long long)addr);
+        }
+
+        /* strided sweep over one allocation */
+        else if (strcmp(cmd, "scan") == 0) {
+            char *idstr = strtok(NULL, " \n");
+            char *stride = strtok(NULL, " \n");
+            char *count = strtok(NULL, " \n");
+            uint64_t base[2], size;
+            sweep_t sw;
+
+            int64_t step;
+            uint64_t n;
+
+            if (!idstr || parse_i64(stride, &step) != 0 ||
+                cli_parse_u64(count, 10, UINT64_MAX, &n) != 0) {
+                printf("Usage: scan <id> <stride> <count>\n");
+                continue;
+            }
+
+            if (!require_heap() || !block_extent(idstr, &base[0], &size))
+                continue;
+
+            if (sweep_scan(&sw, size, step, n) != 0) {
+                printf("Empty block\n");
                 continue;
             }
 
-            void *base = resolve_address(id);
-            if (!base) {
-                printf("Failed to resolve address\n");
+            printf("SCAN: %llu reads over block %s\n",
+                   (unsigned long long)run_sweep(&sw, base), idstr);
+        }
+
+        /* uniform random reads within one allocation */
+        else if (strcmp(cmd, "random") == 0) {
+            char *idstr = strtok(NULL, " \n");
+            char *count = strtok(NULL, " \n");
+            char *seed = strtok(NULL, " \n");
+            uint64_t base[2], size;
+            sweep_t sw;
+
+            uint64_t n, s;
+
+            if (!idstr || cli_parse_u64(count, 10, UINT64_MAX, &n) != 0 ||
+                cli_parse_u64(seed, 10, UINT64_MAX, &s) != 0) {
+                printf("Usage: random <id> <count> <seed>\n");
+                continue;
+            }
+
+            if (!require_heap() || !block_extent(idstr, &base[0], &size))
+                continue;
+
+            if (sweep_random(&sw, size, n, s) != 0) {
+                printf("Empty block\n");
+                continue;
+            }
+
+            printf("RANDOM: %llu reads over block %s\n",
+                   (unsigned long long)run_sweep(&sw, base), idstr);
+        }
+
+        /* word-by-word copy between two allocations */
+        else if (strcmp(cmd, "memcpy") == 0) {
+            char *src = strtok(NULL, " \n");
+            char *dst = strtok(NULL, " \n");
+            char *bytes = strtok(NULL, " \n");
+            uint64_t base[2], src_size, dst_size;
+            sweep_t sw;
+
+            uint64_t n;
+
+            if (!src || !dst || cli_parse_u64(bytes, 10, UINT64_MAX, &n) != 0) {
+                printf("Usage: memcpy <src-id> <dst-id> <bytes>\n");
+                continue;
+            }
+
+            if (!require_heap() ||
+                !block_extent(src, &base[0], &src_size) ||
+                !block_extent(dst, &base[1], &dst_size))
+                continue;
+
+            if (n > src_size || n > dst_size) {
+                printf("Copy exceeds block size\n");
                 continue;
             }
 
-            uint64_t addr = (uint64_t)(uintptr_t)base + offset;
-            cache_access(addr, is_write);
+            if (sweep_memcpy(&sw, n) != 0) {
+                printf("Nothing to copy\n");
+                continue;
+            }
 
-            printf("%s access at address 0x%016llx\n",
-                   is_write ? "WRITE" : "READ",
-                   (unsigned long long)addr);
+            uint64_t issued = run_sweep(&sw, base);
+            printf("MEMCPY: %llu reads, %llu writes from block %s to block %s\n",
+                   (unsigned long long)issued / 2, (unsigned long long)issued / 2,
+                   src, dst);
         }
 
         /* dump */
         else if (strcmp(cmd, "dump") == 0) {
-            mem_dump();
+            if (require_heap())
+                mem_dump(heap);
         }
 
         /* stats */
         else if (strcmp(cmd, "stats") == 0) {
-            mem_stats_print();
+            if (require_heap())
+                mem_stats_print(heap);
         }
 
         /* cache stats */
         else if (strcmp(cmd, "cache_stats") == 0) {
-            cache_report_stats();
+            if (require_heap())
+                cache_report_stats(cache);
+        }
+
+        /* cache settings */
+        else if (strcmp(cmd, "cache") == 0) {
+            char *sub = strtok(NULL, " \n");
+            char *arg = strtok(NULL, " \n");
+
+            if (sub && strcmp(sub, "verbose") == 0 && arg &&
+                (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0)) {
+                cache_verbose = (strcmp(arg, "on") == 0);
+                if (cache)
+                    cache_set_verbose(cache, cache_verbose);
+                printf("Cache trace %s\n", cache_verbose ? "on" : "off");
+            }
+            else if (sub && strcmp(sub, "config") == 0) {
+                /* no file: show the hierarchy in use */
+                if (arg && cache_load_config(arg, &cache_cfg) != 0) {
+                    printf("Cache config not loaded\n");
+                    continue;
+                }
+
+                /* a new hierarchy starts with fresh counters */
+                if (arg && cache) {
+                    cache_t *fresh = cache_create(&cache_cfg);
+                    if (fresh) {
+                        cache_shutdown(cache);
+                        cache = fresh;
+                        cache_set_verbose(cache, cache_verbose);
+                    }
+                }
+                cache_print_config(&cache_cfg);
+            }
+            else {
+                printf("Usage: cache verbose <on|off> | cache config [file]\n");
+            }
+        }
+
+        /* VM stats */
+        else if (strcmp(cmd, "vm_stats") == 0) {
+            if (!vm)
+                printf("VM not enabled\n");
+            else
+                vm_report_stats(vm);
+        }
+
+        /* paging layer */
+        else if (strcmp(cmd, "vm") == 0) {
+            char *sub = strtok(NULL, " \n");
+
+            if (sub && (strcmp(sub, "on") == 0 || strcmp(sub, "off") == 0)) {
+                vm_enabled = (strcmp(sub, "on") == 0);
+                if (!vm_enabled) {
+                    vm_destroy(vm);
+                    vm = NULL;
+                } else if (heap && !vm) {
+                    vm = vm_create(&vm_cfg);
+                }
+                printf("VM %s\n", vm_enabled ? "on" : "off");
+            }
+            else if (sub && strcmp(sub, "config") == 0) {
+                vm_config_t next = vm_cfg;
+                char *field;
+                int changed = 0, bad = 0;
+
+                while ((field = strtok(NULL, " \n")) != NULL) {
+                    if (vm_config_set(&next, field) != 0) {
+                        printf("Bad VM setting: %s\n", field);
+                        bad = 1;
+                        break;
+                    }
+                    changed = 1;
+                }
+                if (bad)
+                    continue;
+                if (vm_validate_config(&next) != 0) {
+                    printf("Invalid VM configuration\n");
+                    continue;
+                }
+                vm_cfg = next;
+
+                /* a new address space starts with fresh mappings */
+                if (changed && vm) {
+                    vm_t *fresh = vm_create(&vm_cfg);
+                    if (fresh) {
+                        vm_destroy(vm);
+                        vm = fresh;
+                    }
+                }
+                vm_print_config(&vm_cfg);
+            }
+            else {
+                printf("Usage: vm <on|off> | vm config [key=value ...]\n");
+            }
+        }
+
+        /* replay a trace on its own heap, current strategy */
+        else if (strcmp(cmd, "replay") == 0) {
+            char *path = strtok(NULL, " \n");
+            char *sz   = strtok(NULL, " \n");
+            char *max  = strtok(NULL, " \n");
+
+            size_t size, limit = 0;
+
+            if (!path || parse_size(sz, &size) != 0 ||
+                (max && parse_size(max, &limit) != 0)) {
+                printf("Usage: replay <trace> <heap-size> [max-size]\n");
+                continue;
+            }
+
+            replay_summary_t sum;
+            mem_heap_t *rh;
+            cache_t *rc = cache_create(&cache_cfg);
+            vm_t *rv = vm_enabled ? vm_create(&vm_cfg) : NULL;
+
+            if (replay_trace(path, cli_algo, size, limit, rc, rv,
+                             cli_sim_base ? &cli_base : NULL, &sum, &rh) != 0) {
+                printf("Replay failed\n");
+            } else {
+                printf("Replayed %s with %s\n", path, algo_name(cli_algo));
+                replay_print_summary(&sum);
+                mem_stats_print(rh);
+                if (rv)
+                    vm_report_stats(rv);
+                if (rc)
+                    cache_report_stats(rc);
+            }
+
+            mem_shutdown(rh);
+            cache_shutdown(rc);
+            vm_destroy(rv);
         }
 
         /* shutdown */
         else if (strcmp(cmd, "shutdown") == 0) {
-            mem_shutdown();
-            cache_shutdown();
-            reset_alloc_table();
+            mem_shutdown(heap);
+            cache_shutdown(cache);
+            vm_destroy(vm);
+            heap = NULL;
+            cache = NULL;
+            vm = NULL;
             printf("Memory shutdown completed\n");
         }
 
@@ -270,4 +648,8 @@ void cli_run(void) {
             printf("Unknown command\n");
         }
     }
+
+    /* a named swap file is removed with its VM */
+    vm_destroy(vm);
+    vm = NULL;
 }
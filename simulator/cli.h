@@ -1,4 +1,12 @@
 #ifndef CLI_H
 #define CLI_H
+
+#include <stdint.h>
+
 void cli_run(void);
+
+/* Whole-string unsigned number in 'base' (0: C prefixes) no larger than
+   'max'; 0, or -1 if 's' is not one. Shared by every numeric argument */
+int cli_parse_u64(const char *s, int base, uint64_t max, uint64_t *out);
+
 #endif
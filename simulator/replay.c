@@ -0,0 +1,235 @@
+#define _GNU_SOURCE
+#include "replay.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ================= TRACE ID MAP ================= */
+
+/*
+ * Trace ID -> allocator ID, indexed directly by trace ID. Traces number
+ * their allocations densely, so a flat array beats hashing.
+ */
+typedef struct {
+    uint32_t *ids;
+    size_t    cap;
+} id_map_t;
+
+static uint32_t *map_slot(id_map_t *m, uint32_t tid)
+{
+    if (tid >= m->cap) {
+        size_t cap = m->cap ? m->cap : 1024;
+        while (cap <= tid)
+            cap *= 2;
+
+        uint32_t *p = realloc(m->ids, cap * sizeof(uint32_t));
+        if (!p)
+            return NULL;
+        memset(p + m->cap, 0, (cap - m->cap) * sizeof(uint32_t));
+        m->ids = p;
+        m->cap = cap;
+    }
+    return &m->ids[tid];
+}
+
+static uint32_t map_get(const id_map_t *m, uint32_t tid)
+{
+    return tid < m->cap ? m->ids[tid] : 0;
+}
+
+/* ================= CACHE FEED ================= */
+
+/* Accesses are handed to the VM and cache models in batches */
+#define ACCESS_BATCH 4096
+
+typedef struct {
+    cache_t *cache;
+    vm_t    *vm;
+    uint64_t addrs[ACCESS_BATCH];
+    uint8_t  is_write[ACCESS_BATCH];
+    size_t   n;
+} access_buf_t;
+
+static void access_flush(access_buf_t *ab)
+{
+    if (ab->n && ab->vm)
+        vm_translate_batch(ab->vm, ab->addrs, ab->is_write, ab->n);
+    if (ab->n && ab->cache)
+        cache_access_batch(ab->cache, ab->addrs, ab->is_write, ab->n);
+    ab->n = 0;
+}
+
+static void access_push(access_buf_t *ab, uint64_t addr, int is_write)
+{
+    ab->addrs[ab->n] = addr;
+    ab->is_write[ab->n] = (uint8_t)is_write;
+    if (++ab->n == ACCESS_BATCH)
+        access_flush(ab);
+}
+
+/* ================= REPLAY ================= */
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int replay_trace(const char *path, algo_t algo, size_t heap_bytes,
+                 size_t heap_max, cache_t *cache, vm_t *vm, const uint64_t *addr_base,
+                 replay_summary_t *out, mem_heap_t **heap_out)
+{
+    access_buf_t *ab = NULL;
+    trace_reader_t tr;
+    const trace_record_t *ev;
+    id_map_t map = {0};
+    volatile uint8_t sink = 0;
+    int r = 0;
+
+    memset(out, 0, sizeof(*out));
+    if (heap_out)
+        *heap_out = NULL;
+
+    if (trace_open(&tr, path) != 0) {
+        fprintf(stderr, "%s: cannot open trace\n", path);
+        return -1;
+    }
+
+    mem_heap_t *heap = heap_max > heap_bytes
+                           ? mem_init_growable(heap_bytes, heap_max)
+                           : mem_init(heap_bytes);
+    if (!heap || set_allocator_algo(heap, algo) != 0) {
+        mem_shutdown(heap);
+        trace_close(&tr);
+        return -1;
+    }
+    if (addr_base)
+        mem_set_address_base(heap, *addr_base);
+
+    /* fixed for the run: the arena never moves, only its end */
+    uint64_t sim_base = mem_address_base(heap);
+    const uint8_t *host_base = allocator_get_base(heap);
+
+    if (cache || vm) {
+        ab = malloc(sizeof(*ab));
+        if (!ab) {
+            mem_shutdown(heap);
+            trace_close(&tr);
+            return -1;
+        }
+        ab->cache = cache;
+        ab->vm = vm;
+        ab->n = 0;
+    }
+
+    double start = now_seconds();
+
+    while ((r = trace_next(&tr, &ev)) > 0) {
+        uint32_t id = map_get(&map, ev->id);
+        out->events++;
+
+        switch (ev->op) {
+        case TRACE_ALLOC: {
+            uint32_t *slot = map_slot(&map, ev->id);
+            if (!slot) {
+                r = -1;
+                goto done;
+            }
+            if (*slot) {
+                out->invalid++;
+                break;
+            }
+
+            *slot = mem_alloc(heap, (size_t)ev->arg);
+            if (!*slot) {
+                out->alloc_failures++;
+                break;
+            }
+            out->allocs++;
+            out->live_bytes += (size_t)ev->arg;
+            if (out->live_bytes > out->peak_live_bytes)
+                out->peak_live_bytes = out->live_bytes;
+            break;
+        }
+
+        case TRACE_FREE: {
+            size_t req = id ? mem_requested_size(heap, id) : 0;
+            if (!id || mem_free(heap, id) != 0) {
+                out->invalid++;
+                break;
+            }
+            map.ids[ev->id] = 0;
+            out->frees++;
+            out->live_bytes -= req;
+            break;
+        }
+
+        case TRACE_READ:
+        case TRACE_WRITE: {
+            uint8_t *p = id ? mem_id_to_ptr(heap, id) : NULL;
+            if (!p || ev->arg >= mem_requested_size(heap, id)) {
+                out->invalid++;
+                break;
+            }
+            if (ev->op == TRACE_READ) {
+                sink ^= p[ev->arg];
+                out->reads++;
+            } else {
+                p[ev->arg] = (uint8_t)ev->id;
+                out->writes++;
+            }
+            if (ab)
+                access_push(ab, sim_base + (uint64_t)(p - host_base) + ev->arg,
+                            ev->op == TRACE_WRITE);
+            break;
+        }
+        }
+    }
+
+done:
+    if (ab)
+        access_flush(ab);
+    free(ab);
+    out->seconds = now_seconds() - start;
+    (void)sink;
+
+    if (r < 0 && tr.fp)
+        fprintf(stderr, "%s:%zu: malformed trace event\n", path, tr.line);
+    else if (r < 0)
+        fprintf(stderr, "%s: malformed or truncated trace\n", path);
+
+    trace_close(&tr);
+    free(map.ids);
+
+    if (heap_out)
+        *heap_out = heap;
+    else
+        mem_shutdown(heap);
+
+    return r < 0 ? -1 : 0;
+}
+
+/* ================= SUMMARY ================= */
+
+void replay_print_summary(const replay_summary_t *s)
+{
+    double rate = s->seconds > 0 ? s->events / s->seconds : 0.0;
+
+    printf("\n---------- REPLAY ----------\n");
+    printf("Events                 : %llu\n", (unsigned long long)s->events);
+    printf("Allocations            : %llu\n", (unsigned long long)s->allocs);
+    printf("Failed allocations     : %llu\n", (unsigned long long)s->alloc_failures);
+    printf("Frees                  : %llu\n", (unsigned long long)s->frees);
+    printf("Reads                  : %llu\n", (unsigned long long)s->reads);
+    printf("Writes                 : %llu\n", (unsigned long long)s->writes);
+    printf("Invalid events         : %llu\n", (unsigned long long)s->invalid);
+    printf("Live bytes at end      : %zu\n", s->live_bytes);
+    printf("Peak live bytes        : %zu\n", s->peak_live_bytes);
+    printf("Elapsed                : %.3f s\n", s->seconds);
+    printf("Throughput             : %.0f events/s\n", rate);
+    printf("----------------------------\n");
+}
@@ -0,0 +1,48 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../allocator/allocator.h"
+#include "../cache/cache.h"
+#include "../vm/vm.h"
+
+/*
+ * Batch trace replay: runs a trace (see trace.h) against a fresh heap
+ * with no per-event output, then reports a summary.
+ */
+
+typedef struct {
+    uint64_t events;
+    uint64_t allocs;
+    uint64_t alloc_failures;
+    uint64_t frees;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t invalid;          /* unknown / reused IDs, out-of-range offsets */
+    size_t   live_bytes;       /* requested bytes still allocated at the end */
+    size_t   peak_live_bytes;
+    double   seconds;          /* wall time of the event loop */
+} replay_summary_t;
+
+/*
+ * Replay 'path' on a new heap of 'heap_bytes' using 'algo'; with
+ * 'heap_max' above 'heap_bytes' the heap may grow up to it.
+ * If 'cache' is non-NULL, reads and writes are also run through it
+ * (in batches, silently unless the cache is in verbose mode).
+ * If 'vm' is non-NULL, each batch is translated through it first and
+ * the cache sees physical addresses.
+ * 'addr_base' points to the heap's simulated base (see
+ * mem_set_address_base()), or is NULL for host addresses.
+ * If 'heap_out' is non-NULL the heap is handed back for inspection
+ * (caller shuts it down), otherwise it is released.
+ * Returns 0, or -1 if the trace cannot be read or is malformed.
+ */
+int replay_trace(const char *path, algo_t algo, size_t heap_bytes,
+                 size_t heap_max, cache_t *cache, vm_t *vm, const uint64_t *addr_base,
+                 replay_summary_t *out, mem_heap_t **heap_out);
+
+void replay_print_summary(const replay_summary_t *s);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,90 @@
+#include "sweep.h"
+
+#include <string.h>
+
+/* ================= SETUP ================= */
+
+int sweep_scan(sweep_t *s, uint64_t size, int64_t stride, uint64_t count)
+{
+    if (size == 0)
+        return -1;
+
+    memset(s, 0, sizeof(*s));
+    s->kind = SWEEP_SCAN;
+    s->size = size;
+    s->left = count;
+
+    /* walking down by k is walking up by size - k */
+    uint64_t mag = (stride < 0) ? -(uint64_t)stride : (uint64_t)stride;
+    mag %= size;
+    s->step = (stride < 0 && mag) ? size - mag : mag;
+    return 0;
+}
+
+int sweep_random(sweep_t *s, uint64_t size, uint64_t count, uint64_t seed)
+{
+    if (size == 0)
+        return -1;
+
+    memset(s, 0, sizeof(*s));
+    s->kind = SWEEP_RANDOM;
+    s->size = size;
+    s->left = count;
+    s->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;   /* xorshift needs nonzero */
+    return 0;
+}
+
+int sweep_memcpy(sweep_t *s, uint64_t bytes)
+{
+    if (bytes == 0)
+        return -1;
+
+    memset(s, 0, sizeof(*s));
+    s->kind = SWEEP_MEMCPY;
+    s->left = 2 * ((bytes + SWEEP_WORD - 1) / SWEEP_WORD);
+    return 0;
+}
+
+/* ================= ITERATION ================= */
+
+static uint64_t next_rand(sweep_t *s)
+{
+    uint64_t x = s->rng;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return s->rng = x;
+}
+
+int sweep_next(sweep_t *s, sweep_step_t *step)
+{
+    if (s->left == 0)
+        return 0;
+    s->left--;
+
+    switch (s->kind) {
+    case SWEEP_SCAN:
+        *step = (sweep_step_t){ .offset = s->pos };
+        s->pos += s->step;
+        if (s->pos >= s->size)
+            s->pos -= s->size;
+        break;
+
+    case SWEEP_RANDOM: {
+        uint64_t words = (s->size + SWEEP_WORD - 1) / SWEEP_WORD;
+        *step = (sweep_step_t){ .offset = (next_rand(s) % words) * SWEEP_WORD };
+        break;
+    }
+
+    case SWEEP_MEMCPY:
+        *step = (sweep_step_t){ .offset = s->pos * SWEEP_WORD,
+                                .block = (uint8_t)s->write_next,
+                                .is_write = (uint8_t)s->write_next };
+        if (s->write_next)
+            s->pos++;
+        s->write_next = !s->write_next;
+        break;
+    }
+    return 1;
+}
@@ -0,0 +1,50 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+
+/*
+ * Address-stream generators behind the scan / random / memcpy commands.
+ * A sweep yields offsets into one allocation (or two, for memcpy); the
+ * CLI turns them into cache accesses, the script converter into trace
+ * events, so both see exactly the same stream.
+ *
+ *   scan    'count' reads from offset 0, 'stride' bytes apart (negative
+ *           strides walk down), wrapping around the allocation
+ *   random  'count' word-aligned reads, uniform over the allocation,
+ *           reproducible from 'seed'
+ *   memcpy  word by word: read the source, write the destination
+ */
+#define SWEEP_WORD 8
+
+typedef enum {
+    SWEEP_SCAN,
+    SWEEP_RANDOM,
+    SWEEP_MEMCPY
+} sweep_kind_t;
+
+typedef struct {
+    uint64_t offset;
+    uint8_t  block;            /* 0 = the (source) allocation, 1 = destination */
+    uint8_t  is_write;
+} sweep_step_t;
+
+typedef struct {
+    sweep_kind_t kind;
+    uint64_t     size;         /* scan / random: allocation bytes */
+    uint64_t     step;         /* scan: stride reduced modulo size */
+    uint64_t     left;         /* steps still to yield */
+    uint64_t     pos;          /* scan: next offset; memcpy: next word */
+    uint64_t     rng;          /* random */
+    int          write_next;   /* memcpy: the write half of the word */
+} sweep_t;
+
+/* 0 on success, -1 if there is nothing to sweep (empty allocation) */
+int sweep_scan(sweep_t *s, uint64_t size, int64_t stride, uint64_t count);
+int sweep_random(sweep_t *s, uint64_t size, uint64_t count, uint64_t seed);
+int sweep_memcpy(sweep_t *s, uint64_t bytes);
+
+/* Next step; 0 once the sweep is exhausted */
+int sweep_next(sweep_t *s, sweep_step_t *step);
+
+#endif /* SWEEP_H */
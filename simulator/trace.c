@@ -0,0 +1,466 @@
+#define _GNU_SOURCE
+#include "trace.h"
+#include "../allocator/allocator.h"
+#include "sweep.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ================= OPEN / CLOSE ================= */
+
+/* Map a binary trace; 1 = mapped, 0 = not a binary trace, -1 = bad */
+static int open_binary(trace_reader_t *tr, const char *path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_header_t)) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+
+    const trace_header_t *hdr = map;
+    if (memcmp(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic)) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return 0;
+    }
+
+    size_t body = (size_t)st.st_size - sizeof(*hdr);
+    if (hdr->byte_order != TRACE_BYTE_ORDER ||
+        hdr->version != TRACE_VERSION ||
+        hdr->record_size != sizeof(trace_record_t) ||
+        hdr->count > body / sizeof(trace_record_t)) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    tr->map = map;
+    tr->map_len = (size_t)st.st_size;
+    tr->recs = (const trace_record_t *)(hdr + 1);
+    tr->count = hdr->count;
+    return 1;
+}
+
+int trace_open(trace_reader_t *tr, const char *path)
+{
+    memset(tr, 0, sizeof(*tr));
+
+    int r = open_binary(tr, path);
+    if (r != 0)
+        return r > 0 ? 0 : -1;
+
+    tr->fp = fopen(path, "r");
+    return tr->fp ? 0 : -1;
+}
+
+void trace_close(trace_reader_t *tr)
+{
+    if (tr->map)
+        munmap(tr->map, tr->map_len);
+    if (tr->fp)
+        fclose(tr->fp);
+    tr->map = NULL;
+    tr->fp = NULL;
+}
+
+/* ================= TEXT ================= */
+
+static const char *skip_space(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+/* Parse one unsigned field; NULL if missing */
+static const char *parse_u64(const char *p, uint64_t *out)
+{
+    char *end;
+
+    p = skip_space(p);
+    if (!isdigit((unsigned char)*p))
+        return NULL;
+
+    *out = strtoull(p, &end, 10);
+    return end;
+}
+
+static int next_text(trace_reader_t *tr, trace_record_t *ev)
+{
+    char line[128];
+
+    while (fgets(line, sizeof(line), tr->fp)) {
+        const char *p = skip_space(line);
+        uint64_t id, arg = 0;
+
+        tr->line++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0')
+            continue;
+
+        memset(ev, 0, sizeof(*ev));
+        ev->time = tr->pos++;
+
+        switch (*p) {
+        case 'a': ev->op = TRACE_ALLOC; break;
+        case 'f': ev->op = TRACE_FREE;  break;
+        case 'r': ev->op = TRACE_READ;  break;
+        case 'w': ev->op = TRACE_WRITE; break;
+        default:  return -1;
+        }
+
+        p = parse_u64(p + 1, &id);
+        if (!p || id > UINT32_MAX)
+            return -1;
+        if (ev->op != TRACE_FREE && !(p = parse_u64(p, &arg)))
+            return -1;
+
+        ev->id = (uint32_t)id;
+        ev->arg = arg;
+        return 1;
+    }
+    return 0;
+}
+
+/* ================= ITERATION ================= */
+
+int trace_next(trace_reader_t *tr, const trace_record_t **ev)
+{
+    if (tr->map) {
+        if (tr->pos == tr->count)
+            return 0;
+
+        *ev = &tr->recs[tr->pos++];
+        return (*ev)->op <= TRACE_WRITE ? 1 : -1;
+    }
+
+    *ev = &tr->scratch;
+    return next_text(tr, &tr->scratch);
+}
+
+/* ================= WRITER ================= */
+
+int trace_writer_open(trace_writer_t *tw, const char *path)
+{
+    trace_header_t hdr = { .magic = TRACE_MAGIC };
+
+    tw->count = 0;
+    tw->fp = fopen(path, "wb");
+    if (!tw->fp)
+        return -1;
+
+    /* count is patched in on close */
+    if (fwrite(&hdr, sizeof(hdr), 1, tw->fp) != 1) {
+        fclose(tw->fp);
+        tw->fp = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int trace_writer_append(trace_writer_t *tw, const trace_record_t *ev)
+{
+    if (fwrite(ev, sizeof(*ev), 1, tw->fp) != 1)
+        return -1;
+    tw->count++;
+    return 0;
+}
+
+int trace_writer_close(trace_writer_t *tw)
+{
+    trace_header_t hdr = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .record_size = sizeof(trace_record_t),
+        .count = tw->count,
+        .byte_order = TRACE_BYTE_ORDER
+    };
+    int r = 0;
+
+    if (fseek(tw->fp, 0, SEEK_SET) != 0 ||
+        fwrite(&hdr, sizeof(hdr), 1, tw->fp) != 1)
+        r = -1;
+    if (fclose(tw->fp) != 0)
+        r = -1;
+    tw->fp = NULL;
+    return r;
+}
+
+/* ================= CLI SCRIPT CONVERTER ================= */
+
+/*
+ * A CLI script refers to allocations by the IDs the allocator printed.
+ * Each allocator numbers its own successful allocations 1, 2, 3, ...:
+ * the fit strategies share one counter and their blocks for the life of
+ * the heap, while buddy and slab restart theirs each time their pool is
+ * rebuilt (on a switch into them) and drop its blocks on a switch out.
+ * The converter keeps one such ID space per allocator, so a script's
+ * IDs map to the allocation it meant. Blocks the heap drops (pool
+ * rebuilt, shutdown) are freed in the trace so replay sees the same
+ * live set. Trace IDs are unique across the whole script.
+ *
+ * Whether a malloc succeeds depends on the heap, so the script is also
+ * run on a shadow heap of the size it initializes, with the same
+ * strategy switches. A malloc that fails there issues no script ID; it
+ * is written as an alloc under a trace ID that nothing else refers to,
+ * so replay makes the same attempt. As at the prompt, commands that
+ * need a heap are dropped while none is initialized, init while one is
+ * live is ignored, and a refused strategy switch keeps the old one.
+ *
+ * scan / random / memcpy expand into the reads and writes the CLI would
+ * issue for them (see sweep.h), using the sizes the script requested.
+ */
+typedef struct {
+    uint32_t  issued;          /* allocator's last ID */
+    uint32_t *tid;             /* trace ID, per allocator ID */
+    uint8_t  *live;            /* per allocator ID */
+    uint64_t *size;            /* requested bytes, per allocator ID */
+    size_t    cap;
+} conv_space_t;
+
+enum { SPACE_FIT, SPACE_BUDDY, SPACE_SLAB, SPACE_COUNT };
+
+typedef struct {
+    trace_writer_t tw;
+    conv_space_t   space[SPACE_COUNT];
+    conv_space_t  *cur;        /* ID space of the script's allocator */
+    uint32_t       next_tid;
+    mem_heap_t    *heap;       /* shadow heap, between init and shutdown */
+    uint64_t       time;
+} cli_conv_t;
+
+static int conv_emit(cli_conv_t *cv, trace_op_t op, uint32_t id, uint64_t arg)
+{
+    trace_record_t ev = {
+        .op = (uint8_t)op,
+        .id = id,
+        .arg = arg,
+        .time = cv->time++
+    };
+    return trace_writer_append(&cv->tw, &ev);
+}
+
+/* Trace ID of a CLI ID; 0 (never allocated) if the script's ID is bogus */
+static uint32_t conv_id(const cli_conv_t *cv, uint32_t k)
+{
+    return (k && k <= cv->cur->issued) ? cv->cur->tid[k] : 0;
+}
+
+/* The allocator restarts its IDs and drops its blocks: free them */
+static int conv_reset(cli_conv_t *cv, conv_space_t *sp)
+{
+    for (uint32_t k = 1; k <= sp->issued; k++) {
+        if (sp->live[k] && conv_emit(cv, TRACE_FREE, sp->tid[k], 0) < 0)
+            return -1;
+    }
+    if (sp->cap)
+        memset(sp->live, 0, sp->cap);
+
+    sp->issued = 0;
+    return 0;
+}
+
+static int conv_reset_all(cli_conv_t *cv)
+{
+    for (int i = 0; i < SPACE_COUNT; i++) {
+        if (conv_reset(cv, &cv->space[i]) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int conv_malloc(cli_conv_t *cv, uint64_t size)
+{
+    conv_space_t *sp = cv->cur;
+    uint32_t k = mem_alloc(cv->heap, (size_t)size);
+
+    if (k == 0)
+        return conv_emit(cv, TRACE_ALLOC, ++cv->next_tid, size);
+    if (k != sp->issued + 1)
+        return -1;              /* lost track of the allocator's IDs */
+
+    if (k >= sp->cap) {
+        size_t cap = sp->cap ? sp->cap * 2 : 1024;
+        uint8_t *p = realloc(sp->live, cap);
+        if (!p)
+            return -1;
+        sp->live = p;
+
+        uint64_t *sz = realloc(sp->size, cap * sizeof(uint64_t));
+        if (!sz)
+            return -1;
+        sp->size = sz;
+
+        uint32_t *t = realloc(sp->tid, cap * sizeof(uint32_t));
+        if (!t)
+            return -1;
+        sp->tid = t;
+
+        memset(p + sp->cap, 0, cap - sp->cap);
+        sp->cap = cap;
+    }
+
+    sp->issued = k;
+    sp->live[k] = 1;
+    sp->size[k] = size;
+    sp->tid[k] = ++cv->next_tid;
+    return conv_emit(cv, TRACE_ALLOC, sp->tid[k], size);
+}
+
+/* CLI ID of a live allocation, or 0 (the CLI would reject the command) */
+static uint32_t conv_live(const cli_conv_t *cv, const char *arg)
+{
+    uint32_t k = (uint32_t)strtoul(arg, NULL, 10);
+    return (conv_id(cv, k) && cv->cur->live[k]) ? k : 0;
+}
+
+static int conv_sweep(cli_conv_t *cv, sweep_t *s, const uint32_t k[2])
+{
+    sweep_step_t st;
+
+    while (sweep_next(s, &st)) {
+        trace_op_t op = st.is_write ? TRACE_WRITE : TRACE_READ;
+        if (conv_emit(cv, op, cv->cur->tid[k[st.block]], st.offset) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* init memory <size> [max]: the shadow heap, as the CLI would build it */
+static int conv_init(cli_conv_t *cv, algo_t algo, uint64_t size, uint64_t max)
+{
+    if (conv_reset_all(cv) < 0)
+        return -1;
+
+    cv->heap = max > size ? mem_init_growable((size_t)size, (size_t)max)
+                          : mem_init((size_t)size);
+    if (cv->heap && set_allocator_algo(cv->heap, algo) != 0) {
+        mem_shutdown(cv->heap);
+        cv->heap = NULL;
+    }
+    return 0;
+}
+
+static conv_space_t *space_of(cli_conv_t *cv, algo_t a)
+{
+    if (a == ALGO_BUDDY)
+        return &cv->space[SPACE_BUDDY];
+    if (a == ALGO_SLAB)
+        return &cv->space[SPACE_SLAB];
+    return &cv->space[SPACE_FIT];
+}
+
+long trace_convert_cli(const char *script_path, const char *trace_path)
+{
+    cli_conv_t cv = {0};
+    algo_t algo = ALGO_FIRST_FIT;
+    char line[256];
+    int r = 0;
+
+    cv.cur = space_of(&cv, algo);
+
+    FILE *in = fopen(script_path, "r");
+    if (!in)
+        return -1;
+
+    if (trace_writer_open(&cv.tw, trace_path) != 0) {
+        fclose(in);
+        return -1;
+    }
+
+    while (r == 0 && fgets(line, sizeof(line), in)) {
+        char *cmd = strtok(line, " \t\r\n");
+        char *a1  = cmd ? strtok(NULL, " \t\r\n") : NULL;
+        char *a2  = a1 ? strtok(NULL, " \t\r\n") : NULL;
+        char *a3  = a2 ? strtok(NULL, " \t\r\n") : NULL;
+        uint32_t k[2];
+        sweep_t sw;
+
+        if (!cmd || cmd[0] == '#')
+            continue;
+
+        if (strcmp(cmd, "malloc") == 0 && a1) {
+            if (cv.heap)
+                r = conv_malloc(&cv, strtoull(a1, NULL, 10));
+        }
+        else if (strcmp(cmd, "free") == 0 && a1) {
+            uint32_t k = (uint32_t)strtoul(a1, NULL, 10);
+            uint32_t id = conv_id(&cv, k);
+            if (id && cv.cur->live[k]) {
+                cv.cur->live[k] = 0;
+                mem_free(cv.heap, k);
+            }
+            r = conv_emit(&cv, TRACE_FREE, id, 0);
+        }
+        else if ((strcmp(cmd, "read") == 0 || strcmp(cmd, "write") == 0) && a1 && a2) {
+            trace_op_t op = (cmd[0] == 'r') ? TRACE_READ : TRACE_WRITE;
+            uint32_t k = (uint32_t)strtoul(a1, NULL, 10);
+            r = conv_emit(&cv, op, conv_id(&cv, k), strtoull(a2, NULL, 10));
+        }
+        else if (strcmp(cmd, "scan") == 0 && a3 && (k[0] = conv_live(&cv, a1))) {
+            if (sweep_scan(&sw, cv.cur->size[k[0]], strtoll(a2, NULL, 10),
+                           strtoull(a3, NULL, 10)) == 0)
+                r = conv_sweep(&cv, &sw, k);
+        }
+        else if (strcmp(cmd, "random") == 0 && a3 && (k[0] = conv_live(&cv, a1))) {
+            if (sweep_random(&sw, cv.cur->size[k[0]], strtoull(a2, NULL, 10),
+                             strtoull(a3, NULL, 10)) == 0)
+                r = conv_sweep(&cv, &sw, k);
+        }
+        else if (strcmp(cmd, "memcpy") == 0 && a3 &&
+                 (k[0] = conv_live(&cv, a1)) && (k[1] = conv_live(&cv, a2))) {
+            uint64_t n = strtoull(a3, NULL, 10);
+            if (n <= cv.cur->size[k[0]] && n <= cv.cur->size[k[1]] &&
+                sweep_memcpy(&sw, n) == 0)
+                r = conv_sweep(&cv, &sw, k);
+        }
+        else if (strcmp(cmd, "init") == 0 && a2 && strcmp(a1, "memory") == 0) {
+            if (!cv.heap)
+                r = conv_init(&cv, algo, strtoull(a2, NULL, 10),
+                              a3 ? strtoull(a3, NULL, 10) : 0);
+        }
+        else if (strcmp(cmd, "shutdown") == 0) {
+            r = conv_reset_all(&cv);
+            mem_shutdown(cv.heap);
+            cv.heap = NULL;
+        }
+        else if (strcmp(cmd, "set") == 0 && a1 && a2 && strcmp(a1, "allocator") == 0) {
+            algo_t next;
+            if (algo_from_name(a2, &next) != 0 || next == algo)
+                continue;
+            if (cv.heap && set_allocator_algo(cv.heap, next) != 0)
+                continue;
+            /* a pool left behind is torn down; fit blocks stay */
+            if (space_of(&cv, algo) != &cv.space[SPACE_FIT])
+                r = conv_reset(&cv, cv.cur);
+            algo = next;
+            cv.cur = space_of(&cv, algo);
+        }
+        /* dump, stats, cache_stats, help, exit: nothing to replay */
+    }
+
+    fclose(in);
+    mem_shutdown(cv.heap);
+    for (int i = 0; i < SPACE_COUNT; i++) {
+        free(cv.space[i].tid);
+        free(cv.space[i].live);
+        free(cv.space[i].size);
+    }
+
+    if (trace_writer_close(&cv.tw) != 0 || r != 0)
+        return -1;
+    return (long)cv.tw.count;
+}
@@ -0,0 +1,101 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Allocation workload traces.
+ *
+ * A trace is a sequence of events naming allocations by the trace's own
+ * IDs (the replay engine maps them to allocator IDs). Two encodings:
+ *
+ * Text, one event per line, '#' starts a comment:
+ *   a <id> <size>       allocate
+ *   f <id>              free
+ *   r <id> <offset>     read one byte of the allocation
+ *   w <id> <offset>     write one byte of the allocation
+ *
+ * Binary: a trace_header_t followed by fixed-width trace_record_t
+ * records in the writing host's byte order, which the header records.
+ * Files starting with TRACE_MAGIC are read as binary: the reader maps
+ * the file and hands out records in place, with no parsing or copying,
+ * so it rejects files written with the other byte order. Text events
+ * get their ordinal as time.
+ */
+
+typedef enum {
+    TRACE_ALLOC = 0,
+    TRACE_FREE,
+    TRACE_READ,
+    TRACE_WRITE
+} trace_op_t;
+
+#define TRACE_MAGIC    "MSTRACE"       /* 8 bytes including NUL */
+#define TRACE_VERSION  3
+#define TRACE_BYTE_ORDER 0x01020304u   /* reads back swapped across orders */
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;              /* sizeof(trace_record_t) */
+    uint64_t count;                    /* number of records */
+    uint32_t byte_order;               /* TRACE_BYTE_ORDER as written */
+    uint32_t pad;
+} trace_header_t;
+
+typedef struct {
+    uint8_t  op;                       /* trace_op_t */
+    uint8_t  pad[3];
+    uint32_t id;                       /* trace allocation ID */
+    uint64_t arg;                      /* size (alloc) or offset (read/write) */
+    uint64_t time;                     /* timestamp, trace-defined units */
+} trace_record_t;
+
+/* ================= READER ================= */
+
+typedef struct {
+    /* binary: the mapped file */
+    void                 *map;
+    size_t                map_len;
+    const trace_record_t *recs;
+    uint64_t              count;
+    uint64_t              pos;
+
+    /* text */
+    FILE                 *fp;
+    size_t                line;        /* current line number */
+    trace_record_t        scratch;     /* last parsed event */
+} trace_reader_t;
+
+/* Open a text or binary trace; 0 on success */
+int  trace_open(trace_reader_t *tr, const char *path);
+void trace_close(trace_reader_t *tr);
+
+/*
+ * Next event: 1 = *ev points at it, 0 = end of trace, -1 = malformed.
+ * The event stays valid until the next call (binary: until close).
+ */
+int  trace_next(trace_reader_t *tr, const trace_record_t **ev);
+
+/* ================= WRITER / CONVERTER ================= */
+
+typedef struct {
+    FILE    *fp;
+    uint64_t count;
+} trace_writer_t;
+
+int  trace_writer_open(trace_writer_t *tw, const char *path);
+int  trace_writer_append(trace_writer_t *tw, const trace_record_t *ev);
+/* Patches the record count into the header; 0 on success */
+int  trace_writer_close(trace_writer_t *tw);
+
+/*
+ * Convert a CLI command script (malloc / free / read / write, as typed
+ * at the prompt) into a binary trace. Returns the number of events
+ * written, or -1 on error. See trace.c for how IDs are mapped.
+ */
+long trace_convert_cli(const char *script_path, const char *trace_path);
+
+#endif /* TRACE_H */
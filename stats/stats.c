@@ -2,57 +2,89 @@
 #include "stats.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <stdatomic.h>
 
 #include "../allocator/allocator.h"
 #include "../allocator/buddy.h"
-
-/* Allocation counters */
-static size_t alloc_requests = 0;
-static size_t alloc_success  = 0;
-static size_t alloc_fail     = 0;
-static size_t alloc_free     = 0;
-
-/* Heap total size */
-static size_t total_memory = 0;
+#include "../allocator/slab.h"
 
 /* =========================
    INIT / SHUTDOWN
    ========================= */
 
-void stats_init(size_t total) {
-    total_memory = total;
-    alloc_requests = alloc_success = alloc_fail = alloc_free = 0;
+void stats_init(stats_t *st, size_t total) {
+    st->total_memory = total;
+    st->peak_memory = total;
+    st->growths = 0;
+    atomic_store(&st->requests, 0);
+    atomic_store(&st->success, 0);
+    atomic_store(&st->fail, 0);
+    atomic_store(&st->frees, 0);
 }
 
-void stats_shutdown(void) {}
+void stats_shutdown(stats_t *st) { (void)st; }
 
 /* =========================
    COUNTERS
    ========================= */
 
-void stats_record_alloc_attempt(void) { alloc_requests++; }
-void stats_record_alloc_success(void) { alloc_success++; }
-void stats_record_alloc_failure(void) { alloc_fail++; }
-void stats_record_free(void)          { alloc_free++; }
+#define COUNT(c) atomic_fetch_add_explicit(&(c), 1, memory_order_relaxed)
+
+void stats_record_alloc_attempt(stats_t *st) { COUNT(st->requests); }
+void stats_record_alloc_success(stats_t *st) { COUNT(st->success); }
+void stats_record_alloc_failure(stats_t *st) { COUNT(st->fail); }
+void stats_record_free(stats_t *st)          { COUNT(st->frees); }
+
+void stats_record_growth(stats_t *st, size_t total) {
+    st->total_memory = total;
+    if (total > st->peak_memory)
+        st->peak_memory = total;
+    st->growths++;
+}
 
 /* unused hooks (kept for API stability) */
-void stats_inc_used(size_t bytes)      { (void)bytes; }
-void stats_dec_used(size_t bytes)      { (void)bytes; }
-void stats_add_internal_frag(size_t b) { (void)b; }
-void stats_set_external_frag(double v) { (void)v; }
-void stats_record_cache_hit(void)      {}
-void stats_record_cache_miss(void)     {}
+void stats_inc_used(stats_t *st, size_t bytes)      { (void)st; (void)bytes; }
+void stats_dec_used(stats_t *st, size_t bytes)      { (void)st; (void)bytes; }
+void stats_add_internal_frag(stats_t *st, size_t b) { (void)st; (void)b; }
+void stats_set_external_frag(stats_t *st, double v) { (void)st; (void)v; }
+void stats_record_cache_hit(stats_t *st)            { (void)st; }
+void stats_record_cache_miss(stats_t *st)           { (void)st; }
 
 /* =========================
    PRINT STATS
    ========================= */
 
-void stats_print(void) {
+/* Heap growth (growable heaps only) and the host memory behind the
+   arena (committed lazily, see backing.h) */
+static void print_arena(mem_heap_t *heap) {
+    const stats_t *st = allocator_get_stats(heap);
+
+    if (allocator_get_limit(heap) > st->total_memory || st->growths > 0) {
+        printf("Heap growth events     : %zu\n", st->growths);
+        printf("Peak heap size         : %zu bytes (limit %zu)\n",
+               st->peak_memory, allocator_get_limit(heap));
+    }
+    printf("Host memory committed  : %zu bytes (peak %zu)\n",
+           allocator_get_committed(heap), allocator_get_peak_committed(heap));
+}
+
+void stats_print(mem_heap_t *heap) {
+    stats_t *st = allocator_get_stats(heap);
+    const buddy_pool_t *bp = allocator_get_buddy(heap);
+    const slab_pool_t *sp = allocator_get_slab(heap);
+    size_t total_memory = st->total_memory;
+    algo_t algo = get_allocator_algo(heap);
+
+    /* one consistent snapshot of the atomic counters */
+    size_t alloc_requests = atomic_load(&st->requests);
+    size_t alloc_success  = atomic_load(&st->success);
+    size_t alloc_fail     = atomic_load(&st->fail);
+    size_t alloc_free     = atomic_load(&st->frees);
 
     /* =========================
        BUDDY ALLOCATOR STATS
        ========================= */
-    if (get_allocator_algo() == ALGO_BUDDY) {
+    if (algo == ALGO_BUDDY) {
 
         size_t used_memory = 0;
         size_t free_memory = 0;
@@ -61,30 +93,21 @@ void stats_print(void) {
         size_t internal_frag = 0;
         size_t largest_free = 0;
 
-        uintptr_t cur = (uintptr_t)buddy_get_base();
-        uintptr_t end = cur + buddy_get_size();
-
-        while (cur < end) {
-            uint32_t id    = *(uint32_t*)cur;
-            uint32_t order = *(uint32_t*)(cur + sizeof(uint32_t));
-            size_t block_size = (size_t)1 << order;
+        block_t b;
 
-            if (id != 0) {
+        for (size_t off = 0; buddy_block_at(bp, off, &b) == 0; off += b.size) {
+            if (!b.free) {
                 used_blocks++;
+                used_memory += b.requested_size;
 
-                size_t req = buddy_allocated_size(id);
-                used_memory += req;
-
-                if (req < block_size)
-                    internal_frag += (block_size - req);
+                if (b.requested_size < b.size)
+                    internal_frag += (b.size - b.requested_size);
             } else {
                 free_blocks++;
-                free_memory += block_size;
-                if (block_size > largest_free)
-                    largest_free = block_size;
+                free_memory += b.size;
+                if (b.size > largest_free)
+                    largest_free = b.size;
             }
-
-            cur += block_size;
         }
 
         double utilization =
@@ -114,17 +137,82 @@ void stats_print(void) {
         printf("Failed allocs          : %zu\n", alloc_fail);
         printf("Frees                  : %zu\n", alloc_free);
         printf("Success rate           : %.2f%%\n", success_rate);
+        print_arena(heap);
         printf("-----------------------------\n");
 
         return;
     }
 
     /* =========================
-       OUT-OF-BAND (FIRST/BEST/WORST)
+       SLAB ALLOCATOR STATS
        ========================= */
+    if (algo == ALGO_SLAB) {
+
+        size_t used_memory = 0;
+        size_t used_blocks = 0;
+        size_t slot_bytes = 0;
+        size_t internal_frag = 0;
+        size_t bound_slabs = 0;
+        slab_class_stats_t cs;
+
+        for (int c = 0; slab_get_class_stats(sp, c, &cs) == 0; c++) {
+            used_memory   += cs.requested_bytes;
+            used_blocks   += cs.live_objs;
+            slot_bytes    += cs.live_objs * cs.obj_size;
+            internal_frag += cs.live_objs * cs.obj_size - cs.requested_bytes;
+            bound_slabs   += cs.slabs;
+        }
+
+        size_t slab_bytes  = slab_get_count(sp) * SLAB_SIZE;
+        size_t empty_bytes = slab_bytes - bound_slabs * SLAB_SIZE;
+        size_t free_memory = slab_bytes - slot_bytes;
+
+        double utilization =
+            total_memory ? (100.0 * used_memory / total_memory) : 0.0;
+
+        /* free space stranded in partially used slabs */
+        double external_frag =
+            (free_memory > 0)
+                ? 1.0 - ((double)empty_bytes / free_memory)
+                : 0.0;
 
-    block_t *blocks = allocator_get_blocks();
-    size_t count = allocator_get_block_count();
+        double success_rate =
+            (alloc_requests > 0)
+                ? (100.0 * alloc_success / alloc_requests)
+                : 0.0;
+
+        printf("\n---------- SUMMARY ----------\n");
+        printf("Total heap size        : %zu bytes\n", total_memory);
+        printf("Used memory            : %zu bytes\n", used_memory);
+        printf("Free memory            : %zu bytes\n", free_memory);
+        printf("Used blocks            : %zu\n", used_blocks);
+        printf("Slabs in use           : %zu / %zu\n", bound_slabs, slab_get_count(sp));
+        printf("Internal fragmentation : %zu bytes\n", internal_frag);
+        printf("Memory utilization     : %.2f%%\n", utilization);
+        printf("External fragmentation : %.3f\n", external_frag);
+        printf("Allocation requests    : %zu\n", alloc_requests);
+        printf("Successful allocs      : %zu\n", alloc_success);
+        printf("Failed allocs          : %zu\n", alloc_fail);
+        printf("Frees                  : %zu\n", alloc_free);
+        printf("Success rate           : %.2f%%\n", success_rate);
+        print_arena(heap);
+        printf("---------- CLASSES ----------\n");
+
+        for (int c = 0; slab_get_class_stats(sp, c, &cs) == 0; c++) {
+            double occupancy =
+                cs.total_slots ? (100.0 * cs.live_objs / cs.total_slots) : 0.0;
+            printf("%4zuB : slabs %-4zu objs %-6zu occupancy %6.2f%%  waste %zu bytes\n",
+                   cs.obj_size, cs.slabs, cs.live_objs, occupancy,
+                   cs.live_objs * cs.obj_size - cs.requested_bytes);
+        }
+        printf("-----------------------------\n");
+
+        return;
+    }
+
+    /* =========================
+       OUT-OF-BAND (FIRST/BEST/WORST)
+       ========================= */
 
     size_t used_memory = 0;
     size_t free_memory = 0;
@@ -132,15 +220,16 @@ void stats_print(void) {
     size_t free_blocks = 0;
     size_t largest_free = 0;
 
-    for (size_t i = 0; i < count; i++) {
-        if (blocks[i].free) {
+    for (const block_t *b = allocator_first_block(heap); b;
+         b = allocator_next_block(heap, b)) {
+        if (b->free) {
             free_blocks++;
-            free_memory += blocks[i].size;
-            if (blocks[i].size > largest_free)
-                largest_free = blocks[i].size;
+            free_memory += b->size;
+            if (b->size > largest_free)
+                largest_free = b->size;
         } else {
             used_blocks++;
-            used_memory += blocks[i].size;
+            used_memory += b->size;
         }
     }
 
@@ -171,5 +260,6 @@ void stats_print(void) {
     printf("Failed allocs          : %zu\n", alloc_fail);
     printf("Frees                  : %zu\n", alloc_free);
     printf("Success rate           : %.2f%%\n", success_rate);
+    print_arena(heap);
     printf("-----------------------------\n");
 }
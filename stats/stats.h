@@ -2,34 +2,51 @@
 #define STATS_H
 
 #include <stddef.h>
+#include <stdatomic.h>
+
+typedef struct mem_heap mem_heap_t;
+
+/* Per-heap counters (atomic: recorded from any thread) */
+typedef struct stats {
+    atomic_size_t requests;
+    atomic_size_t success;
+    atomic_size_t fail;
+    atomic_size_t frees;
+    size_t        total_memory;   /* current heap size */
+    size_t        peak_memory;    /* largest it has grown to */
+    size_t        growths;        /* heap extensions (under the heap lock) */
+} stats_t;
 
 /* initialization */
-void stats_init(size_t total_memory);
-void stats_shutdown(void);
+void stats_init(stats_t *st, size_t total_memory);
+void stats_shutdown(stats_t *st);
 
 /* allocation tracking */
-void stats_record_alloc_attempt(void);
-void stats_record_alloc_success(void);
-void stats_record_alloc_failure(void);
-void stats_record_free(void);
+void stats_record_alloc_attempt(stats_t *st);
+void stats_record_alloc_success(stats_t *st);
+void stats_record_alloc_failure(stats_t *st);
+void stats_record_free(stats_t *st);
+
+/* heap growth: the heap now spans 'total_memory' bytes */
+void stats_record_growth(stats_t *st, size_t total_memory);
 
 /* USER MEMORY (what malloc() asked for) */
-void stats_inc_user_used(size_t requested_bytes);
-void stats_dec_user_used(size_t requested_bytes);
+void stats_inc_user_used(stats_t *st, size_t requested_bytes);
+void stats_dec_user_used(stats_t *st, size_t requested_bytes);
 
 /* FRAGMENTATION (buddy-only) */
-void stats_add_internal_frag(size_t bytes);
-void stats_sub_internal_frag(size_t bytes);
-void stats_set_external_frag(double value);
+void stats_add_internal_frag(stats_t *st, size_t bytes);
+void stats_sub_internal_frag(stats_t *st, size_t bytes);
+void stats_set_external_frag(stats_t *st, double value);
 
 /* allocator overhead (metadata, optional, NOT added to used) */
-void stats_set_allocator_overhead(size_t bytes);
+void stats_set_allocator_overhead(stats_t *st, size_t bytes);
 
 /* cache tracking (optional) */
-void stats_record_cache_hit(void);
-void stats_record_cache_miss(void);
+void stats_record_cache_hit(stats_t *st);
+void stats_record_cache_miss(stats_t *st);
 
-/* output */
-void stats_print(void);
+/* output: summary of the heap's blocks plus its counters */
+void stats_print(mem_heap_t *heap);
 
 #endif
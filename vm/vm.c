@@ -0,0 +1,724 @@
+#define _GNU_SOURCE
+#include "vm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* =========================
+   INTERNAL STRUCTURES
+   ========================= */
+
+/*
+ * Page-table entries are 64-bit words. A leaf holds its frame number
+ * above PTE_PFN_SHIFT and the flags below; an interior entry holds the
+ * child table's address (tables are 8-byte aligned, so the flag bits are
+ * free) with PTE_PRESENT set. A huge page is a leaf one level above the
+ * bottom, flagged PTE_HUGE, whose frame number is the first of an
+ * aligned run of frames. A leaf swapped out keeps its swap slot in place
+ * of the frame number, flagged PTE_SWAPPED instead of PTE_PRESENT.
+ */
+#define PTE_PRESENT   0x1ULL
+#define PTE_HUGE      0x2ULL
+#define PTE_ACCESSED  0x4ULL
+#define PTE_DIRTY     0x8ULL
+#define PTE_FLAGS     0xFULL      /* bits an interior entry may carry */
+#define PTE_SWAPPED   0x10ULL     /* leaves only */
+#define PTE_PFN_SHIFT 12
+
+#define NIL     UINT32_MAX
+#define NO_SLOT UINT32_MAX
+
+typedef struct {
+    uint64_t  tag;                /* vpn << 1 | huge */
+    uint64_t  pfn;
+    uint64_t *pte;                /* for the accessed / dirty bits on hits */
+    uint64_t  stamp;              /* LRU */
+    int       valid;
+} tlb_entry_t;
+
+/* One resident page, when memory has a frame budget */
+typedef struct {
+    uint64_t  vpn;
+    uint64_t *pte;
+    uint64_t  last_use;           /* translation count at the last access */
+    uint32_t  slot;               /* swap copy, or NO_SLOT */
+    uint32_t  prev, next;         /* FIFO / LRU / second-chance order */
+} frame_t;
+
+struct vm {
+    vm_config_t cfg;
+
+    unsigned page_shift;
+    unsigned level_bits;
+    unsigned huge_shift;          /* page_shift + level_bits */
+    uint64_t level_mask;
+
+    uint64_t    *root;
+    tlb_entry_t *tlb;             /* [tlb_sets * tlb_assoc] */
+    int          tlb_sets;
+    uint64_t     clock;
+    uint64_t     next_frame;
+
+    /* page replacement (frame budget only) */
+    frame_t  *frame;              /* [cfg.frames] */
+    uint32_t  head, tail;         /* head = most recently loaded / used */
+    uint32_t  hand;               /* clock / working-set sweep position */
+
+    /* swap device */
+    FILE     *swap;
+    uint8_t  *page_buf;
+    uint32_t  next_slot;
+
+    uint64_t translations;
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t faults;
+    uint64_t huge_faults;
+    uint64_t evictions;
+    uint64_t swap_ins;
+    uint64_t swap_outs;
+    uint64_t tables;              /* page-table nodes allocated */
+    uint64_t cycles;              /* TLB + walk + fault + swap I/O */
+    uint64_t io_cycles;
+};
+
+/* =========================
+   CONFIGURATION
+   ========================= */
+
+static const char *policy_names[] = {
+    "fifo", "lru", "clock", "second-chance", "working-set"
+};
+
+void vm_default_config(vm_config_t *cfg) {
+    *cfg = (vm_config_t){
+        .page_size = 4096,
+        .levels = 4,
+        .va_bits = VM_VA_BITS,
+        .tlb_entries = 64,
+        .tlb_assoc = 4,
+        .tlb_latency = 1,
+        .walk_latency = 20,
+        .fault_latency = 1000,
+        .huge_pages = 0,
+        .frames = 0,
+        .page_policy = VM_PAGE_LRU,
+        .ws_window = 10000,
+        .swap_latency = 100000,
+        .swap_path = "",
+    };
+}
+
+static int is_pow2(size_t v) {
+    return v && !(v & (v - 1));
+}
+
+static unsigned log2_of(uint64_t v) {
+    return (unsigned)__builtin_ctzll(v);
+}
+
+/* Index bits per table, rounded up so the tables cover va_bits */
+static unsigned level_bits_of(const vm_config_t *cfg) {
+    unsigned idx = (unsigned)cfg->va_bits - log2_of(cfg->page_size);
+    return (idx + (unsigned)cfg->levels - 1) / (unsigned)cfg->levels;
+}
+
+int vm_validate_config(const vm_config_t *cfg) {
+    if (!is_pow2(cfg->page_size) || cfg->page_size < 1024 ||
+        cfg->levels < 1 || cfg->levels > VM_MAX_LEVELS ||
+        cfg->va_bits < 16 || cfg->va_bits > 64 ||
+        (unsigned)cfg->va_bits <= log2_of(cfg->page_size) ||
+        cfg->tlb_entries < 1 || cfg->tlb_assoc < 1 ||
+        cfg->tlb_entries % cfg->tlb_assoc != 0 ||
+        cfg->frames >= NIL ||
+        cfg->page_policy < VM_PAGE_FIFO ||
+        cfg->page_policy > VM_PAGE_WORKING_SET)
+        return -1;
+
+    if (level_bits_of(cfg) > VM_MAX_LEVEL_BITS)
+        return -1;
+    return 0;
+}
+
+/* Number with optional K / M / G suffix */
+static int parse_size(const char *s, size_t *out) {
+    char *end;
+    unsigned long long v = strtoull(s, &end, 10);
+
+    if (end == s)
+        return -1;
+
+    switch (toupper((unsigned char)*end)) {
+    case 'K': v <<= 10; end++; break;
+    case 'M': v <<= 20; end++; break;
+    case 'G': v <<= 30; end++; break;
+    }
+    if (*end != '\0')
+        return -1;
+
+    *out = (size_t)v;
+    return 0;
+}
+
+int vm_config_set(vm_config_t *cfg, const char *field) {
+    const char *eq = strchr(field, '=');
+    char key[32];
+    size_t v;
+
+    if (!eq || (size_t)(eq - field) >= sizeof(key))
+        return -1;
+    memcpy(key, field, (size_t)(eq - field));
+    key[eq - field] = '\0';
+    const char *val = eq + 1;
+
+    if (strcmp(key, "huge") == 0) {
+        if (strcmp(val, "on") != 0 && strcmp(val, "off") != 0)
+            return -1;
+        cfg->huge_pages = (strcmp(val, "on") == 0);
+        return 0;
+    }
+
+    if (strcmp(key, "policy") == 0) {
+        for (int p = VM_PAGE_FIFO; p <= VM_PAGE_WORKING_SET; p++) {
+            if (strcmp(val, policy_names[p]) == 0) {
+                cfg->page_policy = p;
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    if (strcmp(key, "swap") == 0) {
+        if (strlen(val) >= sizeof(cfg->swap_path))
+            return -1;
+        strcpy(cfg->swap_path, val);
+        return 0;
+    }
+
+    if (parse_size(val, &v) != 0)
+        return -1;
+
+    if (strcmp(key, "page") == 0)
+        cfg->page_size = v;
+    else if (strcmp(key, "levels") == 0)
+        cfg->levels = (int)v;
+    else if (strcmp(key, "va_bits") == 0)
+        cfg->va_bits = (int)v;
+    else if (strcmp(key, "tlb") == 0)
+        cfg->tlb_entries = (int)v;
+    else if (strcmp(key, "tlb_assoc") == 0)
+        cfg->tlb_assoc = (int)v;
+    else if (strcmp(key, "tlb_latency") == 0)
+        cfg->tlb_latency = (uint32_t)v;
+    else if (strcmp(key, "walk_latency") == 0)
+        cfg->walk_latency = (uint32_t)v;
+    else if (strcmp(key, "fault_latency") == 0)
+        cfg->fault_latency = (uint32_t)v;
+    else if (strcmp(key, "frames") == 0)
+        cfg->frames = v;
+    else if (strcmp(key, "ws_window") == 0)
+        cfg->ws_window = v;
+    else if (strcmp(key, "swap_latency") == 0)
+        cfg->swap_latency = (uint32_t)v;
+    else
+        return -1;
+    return 0;
+}
+
+void vm_print_config(const vm_config_t *cfg) {
+    printf("Pages       : %zu bytes, %d-level table, %d-bit addresses\n",
+           cfg->page_size, cfg->levels, cfg->va_bits);
+    if (vm_validate_config(cfg) == 0 && cfg->huge_pages && cfg->levels > 1 &&
+        cfg->frames == 0)
+        printf("Huge pages  : on, %llu bytes\n",
+               (unsigned long long)cfg->page_size << level_bits_of(cfg));
+    else
+        printf("Huge pages  : off\n");
+    printf("TLB         : %d entries, %d-way, %u cycles\n",
+           cfg->tlb_entries, cfg->tlb_assoc, cfg->tlb_latency);
+    printf("Walk        : %u cycles per level\n", cfg->walk_latency);
+    printf("Page fault  : %u cycles\n", cfg->fault_latency);
+
+    if (cfg->frames == 0) {
+        printf("Frames      : unlimited\n");
+        return;
+    }
+    printf("Frames      : %zu (%zu bytes), %s replacement",
+           cfg->frames, cfg->frames * cfg->page_size,
+           cfg->page_policy >= VM_PAGE_FIFO && cfg->page_policy <= VM_PAGE_WORKING_SET
+               ? policy_names[cfg->page_policy] : "?");
+    if (cfg->page_policy == VM_PAGE_WORKING_SET)
+        printf(", window %llu", (unsigned long long)cfg->ws_window);
+    printf("\n");
+    printf("Swap        : %s, %u cycles per page\n",
+           cfg->swap_path[0] ? cfg->swap_path : "temporary file",
+           cfg->swap_latency);
+}
+
+/* =========================
+   LIFECYCLE
+   ========================= */
+
+static uint64_t *new_table(vm_t *vm) {
+    uint64_t *t = calloc((size_t)1 << vm->level_bits, sizeof(uint64_t));
+
+    if (t)
+        vm->tables++;
+    return t;
+}
+
+vm_t *vm_create(const vm_config_t *cfg) {
+    if (vm_validate_config(cfg) != 0)
+        return NULL;
+
+    vm_t *vm = calloc(1, sizeof(*vm));
+    if (!vm)
+        return NULL;
+
+    vm->cfg = *cfg;
+    vm->page_shift = log2_of(cfg->page_size);
+    vm->level_bits = level_bits_of(cfg);
+    vm->huge_shift = vm->page_shift + vm->level_bits;
+    vm->level_mask = ((uint64_t)1 << vm->level_bits) - 1;
+
+    /* huge pages are leaves one level up, so they need two levels, and
+       they are not paged out */
+    if (cfg->levels < 2 || cfg->frames > 0)
+        vm->cfg.huge_pages = 0;
+
+    vm->tlb_sets = cfg->tlb_entries / cfg->tlb_assoc;
+    vm->tlb = calloc((size_t)cfg->tlb_entries, sizeof(tlb_entry_t));
+    vm->root = new_table(vm);
+    if (!vm->tlb || !vm->root) {
+        vm_destroy(vm);
+        return NULL;
+    }
+
+    if (cfg->frames > 0) {
+        vm->frame = calloc(cfg->frames, sizeof(frame_t));
+        vm->page_buf = calloc(1, cfg->page_size);
+        vm->swap = cfg->swap_path[0] ? fopen(cfg->swap_path, "w+b") : tmpfile();
+        if (!vm->frame || !vm->page_buf || !vm->swap) {
+            vm_destroy(vm);
+            return NULL;
+        }
+        vm->head = vm->tail = NIL;
+    }
+    return vm;
+}
+
+static void free_table(const vm_t *vm, uint64_t *t, int level) {
+    if (level < vm->cfg.levels - 1) {
+        for (uint64_t i = 0; i <= vm->level_mask; i++) {
+            if ((t[i] & PTE_PRESENT) && !(t[i] & PTE_HUGE))
+                free_table(vm, (uint64_t *)(uintptr_t)(t[i] & ~PTE_FLAGS), level + 1);
+        }
+    }
+    free(t);
+}
+
+void vm_destroy(vm_t *vm) {
+    if (!vm)
+        return;
+
+    if (vm->root)
+        free_table(vm, vm->root, 0);
+    if (vm->swap) {
+        fclose(vm->swap);
+        if (vm->cfg.swap_path[0])
+            remove(vm->cfg.swap_path);
+    }
+    free(vm->page_buf);
+    free(vm->frame);
+    free(vm->tlb);
+    free(vm);
+}
+
+/* =========================
+   TLB
+   ========================= */
+
+static tlb_entry_t *tlb_lookup(vm_t *vm, uint64_t vpn, int huge) {
+    tlb_entry_t *set = &vm->tlb[(vpn % (uint64_t)vm->tlb_sets) * vm->cfg.tlb_assoc];
+    uint64_t tag = vpn << 1 | (uint64_t)huge;
+
+    for (int w = 0; w < vm->cfg.tlb_assoc; w++) {
+        if (set[w].valid && set[w].tag == tag) {
+            set[w].stamp = ++vm->clock;
+            return &set[w];
+        }
+    }
+    return NULL;
+}
+
+static tlb_entry_t *tlb_insert(vm_t *vm, uint64_t vpn, int huge, uint64_t pfn, uint64_t *pte) {
+    tlb_entry_t *set = &vm->tlb[(vpn % (uint64_t)vm->tlb_sets) * vm->cfg.tlb_assoc];
+    tlb_entry_t *victim = &set[0];
+
+    for (int w = 0; w < vm->cfg.tlb_assoc; w++) {
+        if (!set[w].valid) {
+            victim = &set[w];
+            break;
+        }
+        if (set[w].stamp < victim->stamp)
+            victim = &set[w];
+    }
+
+    *victim = (tlb_entry_t){ .tag = vpn << 1 | (uint64_t)huge, .pfn = pfn,
+                             .pte = pte, .stamp = ++vm->clock, .valid = 1 };
+    return victim;
+}
+
+/* Drop the translation of a base page that is being unmapped */
+static void tlb_invalidate(vm_t *vm, uint64_t vpn) {
+    tlb_entry_t *set = &vm->tlb[(vpn % (uint64_t)vm->tlb_sets) * vm->cfg.tlb_assoc];
+
+    for (int w = 0; w < vm->cfg.tlb_assoc; w++) {
+        if (set[w].valid && set[w].tag == vpn << 1)
+            set[w].valid = 0;
+    }
+}
+
+/* =========================
+   SWAP DEVICE
+   ========================= */
+
+/* Swap slots stay with their page once given, so they are only handed
+   out, never returned */
+static uint32_t slot_alloc(vm_t *vm) {
+    return vm->next_slot++;
+}
+
+/*
+ * Page I/O. The model keeps no page contents, so a page-sized buffer
+ * stamped with the page number stands in for them; the transfer itself
+ * is real, the cost charged is swap_latency.
+ */
+static void swap_io(vm_t *vm, uint32_t slot, uint64_t vpn, int out) {
+    off_t off = (off_t)slot * (off_t)vm->cfg.page_size;
+    size_t done = 0;
+
+    if (fseeko(vm->swap, off, SEEK_SET) == 0) {
+        if (out) {
+            memcpy(vm->page_buf, &vpn, sizeof(vpn));
+            done = fwrite(vm->page_buf, vm->cfg.page_size, 1, vm->swap);
+        } else {
+            done = fread(vm->page_buf, vm->cfg.page_size, 1, vm->swap);
+        }
+    }
+    if (done != 1)
+        fprintf(stderr, "vm: swap %s failed for slot %u\n",
+                out ? "write" : "read", slot);
+
+    if (out)
+        vm->swap_outs++;
+    else
+        vm->swap_ins++;
+    vm->io_cycles += vm->cfg.swap_latency;
+    vm->cycles += vm->cfg.swap_latency;
+}
+
+/* =========================
+   PAGE REPLACEMENT
+   ========================= */
+
+static void order_unlink(vm_t *vm, uint32_t f) {
+    frame_t *fr = vm->frame;
+
+    if (fr[f].prev != NIL)
+        fr[fr[f].prev].next = fr[f].next;
+    else
+        vm->head = fr[f].next;
+    if (fr[f].next != NIL)
+        fr[fr[f].next].prev = fr[f].prev;
+    else
+        vm->tail = fr[f].prev;
+}
+
+static void order_push(vm_t *vm, uint32_t f) {
+    frame_t *fr = vm->frame;
+
+    fr[f].prev = NIL;
+    fr[f].next = vm->head;
+    if (vm->head != NIL)
+        fr[vm->head].prev = f;
+    else
+        vm->tail = f;
+    vm->head = f;
+}
+
+/* Test and clear the referenced bit of a resident page */
+static int referenced(frame_t *f) {
+    int r = (*f->pte & PTE_ACCESSED) != 0;
+
+    *f->pte &= ~PTE_ACCESSED;
+    return r;
+}
+
+/* Frame to give up when memory is full */
+static uint32_t choose_victim(vm_t *vm) {
+    frame_t *fr = vm->frame;
+    uint32_t n = (uint32_t)vm->cfg.frames;
+
+    switch (vm->cfg.page_policy) {
+    case VM_PAGE_SECOND_CHANCE:
+        /* FIFO, but a referenced page goes back to the young end */
+        while (referenced(&fr[vm->tail])) {
+            uint32_t f = vm->tail;
+            order_unlink(vm, f);
+            order_push(vm, f);
+        }
+        return vm->tail;
+
+    case VM_PAGE_CLOCK:
+        for (;;) {
+            uint32_t f = vm->hand;
+            vm->hand = (vm->hand + 1) % n;
+            if (!referenced(&fr[f]))
+                return f;
+        }
+
+    case VM_PAGE_WORKING_SET: {
+        /* WSClock: first unreferenced page idle for longer than the
+           window; failing that, the least recently used one seen */
+        uint32_t oldest = vm->hand;
+
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t f = vm->hand;
+            vm->hand = (vm->hand + 1) % n;
+            if (referenced(&fr[f]))
+                continue;
+            if (vm->translations - fr[f].last_use > vm->cfg.ws_window)
+                return f;
+            if (fr[f].last_use < fr[oldest].last_use)
+                oldest = f;
+        }
+        return oldest;
+    }
+
+    default:    /* FIFO and LRU keep their order list up to date */
+        return vm->tail;
+    }
+}
+
+/*
+ * Unmap the page in frame f. A dirty page is written to its swap slot;
+ * a clean one keeps the swap copy it came from, or is dropped entirely
+ * if it was never written.
+ */
+static void evict(vm_t *vm, uint32_t f) {
+    frame_t *fr = &vm->frame[f];
+
+    tlb_invalidate(vm, fr->vpn);
+    vm->evictions++;
+
+    if (*fr->pte & PTE_DIRTY) {
+        if (fr->slot == NO_SLOT)
+            fr->slot = slot_alloc(vm);
+        swap_io(vm, fr->slot, fr->vpn, 1);
+    }
+
+    *fr->pte = fr->slot == NO_SLOT ? 0 :
+               (uint64_t)fr->slot << PTE_PFN_SHIFT | PTE_SWAPPED;
+    order_unlink(vm, f);
+}
+
+/* Frame for a faulting page: a never-used one, or a victim's */
+static uint64_t take_frame(vm_t *vm) {
+    if (vm->next_frame < vm->cfg.frames)
+        return vm->next_frame++;
+
+    uint32_t f = choose_victim(vm);
+    evict(vm, f);
+    return f;
+}
+
+/* Record an access to a resident page */
+static void frame_touch(vm_t *vm, uint64_t pfn) {
+    frame_t *fr = &vm->frame[pfn];
+
+    fr->last_use = vm->translations;
+    if (vm->cfg.page_policy == VM_PAGE_LRU && vm->head != (uint32_t)pfn) {
+        order_unlink(vm, (uint32_t)pfn);
+        order_push(vm, (uint32_t)pfn);
+    }
+}
+
+/* =========================
+   PAGE TABLE
+   ========================= */
+
+static uint64_t table_index(const vm_t *vm, uint64_t va, int level) {
+    unsigned shift = vm->page_shift +
+                     vm->level_bits * (unsigned)(vm->cfg.levels - 1 - level);
+    return (va >> shift) & vm->level_mask;
+}
+
+/* Next free frame, aligned to 'align' frames (no frame budget) */
+static uint64_t alloc_frames(vm_t *vm, uint64_t align) {
+    uint64_t pfn = (vm->next_frame + align - 1) & ~(align - 1);
+
+    vm->next_frame = pfn + align;
+    return pfn;
+}
+
+/* Map the base page of 'va' whose leaf entry is 'pte' */
+static void page_fault(vm_t *vm, uint64_t va, uint64_t *pte) {
+    vm->faults++;
+    vm->cycles += vm->cfg.fault_latency;
+
+    if (!vm->frame) {
+        *pte = alloc_frames(vm, 1) << PTE_PFN_SHIFT | PTE_PRESENT;
+        return;
+    }
+
+    uint64_t pfn = take_frame(vm);
+    frame_t *fr = &vm->frame[pfn];
+
+    fr->vpn = va >> vm->page_shift;
+    fr->pte = pte;
+    fr->slot = NO_SLOT;
+    if (*pte & PTE_SWAPPED) {
+        fr->slot = (uint32_t)(*pte >> PTE_PFN_SHIFT);
+        swap_io(vm, fr->slot, fr->vpn, 0);
+    }
+
+    *pte = pfn << PTE_PFN_SHIFT | PTE_PRESENT;
+    order_push(vm, (uint32_t)pfn);
+}
+
+/*
+ * Walk the table for 'va', mapping its page (or huge page) on first
+ * touch. Returns the leaf entry, or NULL if a table could not be
+ * allocated; *huge tells which kind of leaf it is.
+ */
+static uint64_t *vm_walk(vm_t *vm, uint64_t va, int *huge) {
+    uint64_t *table = vm->root;
+    int last = vm->cfg.levels - 1;
+
+    for (int level = 0; ; level++) {
+        uint64_t *pte = &table[table_index(vm, va, level)];
+
+        vm->cycles += vm->cfg.walk_latency;
+
+        if (level == last || (*pte & PTE_HUGE)) {
+            if (!(*pte & PTE_PRESENT))
+                page_fault(vm, va, pte);
+            *huge = (level != last);
+            return pte;
+        }
+
+        if (!(*pte & PTE_PRESENT)) {
+            /* an untouched region one level above the leaves */
+            if (vm->cfg.huge_pages && level == last - 1) {
+                vm->faults++;
+                vm->huge_faults++;
+                vm->cycles += vm->cfg.fault_latency;
+                *pte = alloc_frames(vm, vm->level_mask + 1) << PTE_PFN_SHIFT |
+                       PTE_PRESENT | PTE_HUGE;
+                *huge = 1;
+                return pte;
+            }
+
+            uint64_t *child = new_table(vm);
+            if (!child)
+                return NULL;
+            *pte = (uint64_t)(uintptr_t)child | PTE_PRESENT;
+        }
+        table = (uint64_t *)(uintptr_t)(*pte & ~PTE_FLAGS);
+    }
+}
+
+/* =========================
+   TRANSLATION
+   ========================= */
+
+uint64_t vm_translate(vm_t *vm, uint64_t va, int is_write) {
+    uint64_t vpn = va >> vm->page_shift;
+    tlb_entry_t *e;
+    unsigned shift;
+
+    vm->translations++;
+    vm->cycles += vm->cfg.tlb_latency;
+
+    e = tlb_lookup(vm, vpn, 0);
+    if (!e && vm->cfg.huge_pages)
+        e = tlb_lookup(vm, va >> vm->huge_shift, 1);
+
+    if (e) {
+        vm->tlb_hits++;
+        shift = (e->tag & 1) ? vm->huge_shift : vm->page_shift;
+    } else {
+        int huge;
+        uint64_t *pte;
+
+        vm->tlb_misses++;
+        pte = vm_walk(vm, va, &huge);
+        if (!pte)
+            return va;   /* out of memory: leave it untranslated */
+
+        shift = huge ? vm->huge_shift : vm->page_shift;
+        e = tlb_insert(vm, va >> shift, huge, *pte >> PTE_PFN_SHIFT, pte);
+    }
+
+    *e->pte |= is_write ? PTE_ACCESSED | PTE_DIRTY : PTE_ACCESSED;
+    if (vm->frame)
+        frame_touch(vm, e->pfn);
+
+    return (e->pfn << vm->page_shift) + (va & (((uint64_t)1 << shift) - 1));
+}
+
+void vm_translate_batch(vm_t *vm, uint64_t *addrs, const uint8_t *is_write,
+                        size_t n) {
+    for (size_t i = 0; i < n; i++)
+        addrs[i] = vm_translate(vm, addrs[i], is_write ? is_write[i] : 0);
+}
+
+/* =========================
+   STATS / REPORTING
+   ========================= */
+
+void vm_report_stats(const vm_t *vm) {
+    uint64_t total = vm->tlb_hits + vm->tlb_misses;
+    double rate = total ? (double)vm->tlb_hits / total * 100.0 : 0.0;
+    uint64_t huge = vm->huge_faults;
+    uint64_t pages = vm->faults - huge;
+
+    printf("\n=========== VM STATS ===========\n");
+    printf("Translations   : %llu\n", (unsigned long long)vm->translations);
+    printf("TLB Hits: %llu  Misses: %llu  HitRate: %.2f%%\n",
+           (unsigned long long)vm->tlb_hits,
+           (unsigned long long)vm->tlb_misses, rate);
+    printf("Page Faults    : %llu (%llu huge)\n",
+           (unsigned long long)vm->faults, (unsigned long long)huge);
+
+    if (vm->frame) {
+        printf("Frames         : %llu of %zu in use, %s replacement\n",
+               (unsigned long long)vm->next_frame, vm->cfg.frames,
+               policy_names[vm->cfg.page_policy]);
+        printf("Evictions      : %llu\n", (unsigned long long)vm->evictions);
+        printf("Swap-ins: %llu  Swap-outs: %llu  Swap I/O: %llu bytes\n",
+               (unsigned long long)vm->swap_ins,
+               (unsigned long long)vm->swap_outs,
+               (unsigned long long)(vm->swap_ins + vm->swap_outs) *
+                   vm->cfg.page_size);
+        printf("Swap Cycles    : %llu\n", (unsigned long long)vm->io_cycles);
+        if (vm->translations > 0)
+            printf("Fault Rate     : %.3f per 1000 accesses\n",
+                   (double)vm->faults * 1000.0 / vm->translations);
+    } else {
+        printf("Mapped         : %llu pages, %llu huge pages\n",
+               (unsigned long long)pages, (unsigned long long)huge);
+    }
+
+    printf("Page Tables    : %llu (%llu bytes)\n",
+           (unsigned long long)vm->tables,
+           (unsigned long long)vm->tables << (vm->level_bits + 3));
+    printf("Trans. Cycles  : %llu\n", (unsigned long long)vm->cycles);
+    if (vm->translations > 0)
+        printf("Avg Trans. Cost: %.2f cycles\n",
+               (double)vm->cycles / vm->translations);
+    printf("================================\n");
+}
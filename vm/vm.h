@@ -0,0 +1,92 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Virtual memory model: translates the simulated program's (virtual)
+ * addresses into physical ones before they reach the cache model.
+ *
+ * A multi-level radix page table maps pages to physical frames, which
+ * are handed out in order on first touch (each first touch is a page
+ * fault). A set-associative TLB caches translations; a TLB miss walks
+ * the table one level at a time. With huge pages on, a fault in an
+ * untouched huge-page-sized region maps the whole region with a single
+ * entry one level above the leaves (page size << bits per level, e.g.
+ * 2 MB over 4 KB pages with 512-entry tables).
+ *
+ * With a frame budget, a fault on a full memory evicts a resident page
+ * chosen by the replacement policy. Dirty victims are written to a
+ * file-backed swap device and read back on their next fault; clean
+ * victims with a swap copy are dropped, and never-written ones are
+ * dropped and refilled with zeros. Huge pages are only mapped without
+ * a budget.
+ *
+ * All costs are in cycles and reported separately from the cache's.
+ */
+
+#define VM_VA_BITS      48        /* default; host pointers fit */
+#define VM_MAX_LEVELS   5
+#define VM_MAX_LEVEL_BITS 16      /* index bits per table, so tables stay small */
+
+/* Page replacement policies */
+#define VM_PAGE_FIFO           0
+#define VM_PAGE_LRU            1
+#define VM_PAGE_CLOCK          2
+#define VM_PAGE_SECOND_CHANCE  3
+#define VM_PAGE_WORKING_SET    4
+
+#define VM_SWAP_PATH_MAX 128
+
+typedef struct {
+    size_t   page_size;           /* bytes, power of two, >= 1 KB */
+    int      levels;              /* page-table levels, 1..VM_MAX_LEVELS */
+    int      va_bits;             /* translated address bits, up to 64 */
+    int      tlb_entries;
+    int      tlb_assoc;           /* ways; must divide tlb_entries */
+    uint32_t tlb_latency;         /* cycles per lookup, hit or miss */
+    uint32_t walk_latency;        /* cycles per page-table level read */
+    uint32_t fault_latency;       /* cycles to service a page fault */
+    int      huge_pages;          /* map untouched regions as huge pages */
+
+    size_t   frames;              /* physical frames, 0 = unlimited */
+    int      page_policy;         /* VM_PAGE_* */
+    uint64_t ws_window;           /* working-set window, in accesses */
+    uint32_t swap_latency;        /* cycles per page read or written */
+    char     swap_path[VM_SWAP_PATH_MAX];   /* "" = anonymous temp file */
+} vm_config_t;
+
+/* 4 KB pages, 4 levels, 64-entry 4-way TLB, unlimited frames */
+void vm_default_config(vm_config_t *cfg);
+
+/* 0 if the configuration is usable: the page-table index bits
+   (va_bits - log2 page_size) must split into 'levels' tables of at most
+   VM_MAX_LEVEL_BITS bits each */
+int vm_validate_config(const vm_config_t *cfg);
+
+/* Set one "key=value" field (page, levels, va_bits, tlb, tlb_assoc,
+   tlb_latency, walk_latency, fault_latency, huge, frames, policy,
+   ws_window, swap_latency, swap); 0 on success */
+int vm_config_set(vm_config_t *cfg, const char *field);
+
+void vm_print_config(const vm_config_t *cfg);
+
+/* One address space; independent instances never share state */
+typedef struct vm vm_t;
+
+/* NULL if the configuration is invalid, memory runs out or the swap
+   file cannot be created (a named one is removed again on destroy) */
+vm_t *vm_create(const vm_config_t *cfg);
+void  vm_destroy(vm_t *vm);
+
+/* Physical address of 'va', mapping its page on first touch */
+uint64_t vm_translate(vm_t *vm, uint64_t va, int is_write);
+
+/* Translate n addresses in place (the batch feed in front of the cache) */
+void vm_translate_batch(vm_t *vm, uint64_t *addrs, const uint8_t *is_write,
+                        size_t n);
+
+void vm_report_stats(const vm_t *vm);
+
+#endif /* VM_H */